@@ -66,10 +66,36 @@ if(getRversion() >= "2.15.1") utils::globalVariables(Names)
 #' May differ from MSY statistics from last historical year if there are changes in productivity
 #' @param silent Should messages be printed out to the console?
 #' @param PPD Logical. Should posterior predicted data be included in the MSE object Misc slot?
-#' @param parallel Logical. Should the MSE be run using parallel processing?
-#' @param save_name Character. Optional name to save parallel MSE list
+#' @param parallel Logical or character. Should the MSE be run using parallel processing?
+#' In both cases the historical simulations are run once and shared with the cores
+#' through a memory-mapped store (written to `control$StoreDir`, default `tempdir()`).
+#' `TRUE` splits the projections into tasks (a block of simulations for one MP)
+#' that are handed out to the cores as they become free. The number of simulations 
+#' in each block can be set with `control$SimBlock` (default aims for about 4 tasks 
+#' per core). Each pair of simulations is projected with its own random number seed, 
+#' so the results do not depend on the number of cores or `control$SimBlock`.
+#' `'MPs'` runs the projections for each MP on a separate core.
+#' @param save_name Character. Optional name to save the MSE object in parallel mode
 #' @param checks Logical. Run tests?
-#' @param control control options for testing and debugging
+#' @param control control options for testing and debugging. If `control$checkpoint` 
+#' is the path to a directory, the historical simulations and the projections 
+#' are saved there as the MSE runs, and an interrupted run can be continued with 
+#' \link{resumeMSE}. If `control$ResultStore` is the path to a directory, the 
+#' projection results are written there as each MP finishes and the arrays 
+#' in the MSE object are read from disk when they are used. If `control$converge` 
+#' is `TRUE`, the running means of the performance metrics (as plotted by 
+#' \link{Converge}) are updated as each block of simulations is completed and 
+#' the projections are stopped once they have converged. `control$converge` can 
+#' also be a list with the names of the PM functions (`PMs`, default 
+#' `c('Yield', 'P10', 'AAVY')`), `thresh` and `ref.it` (see \link{Converge}), 
+#' the number of simulations in each block (`block`, default 10), and `stop` 
+#' (default `TRUE`). The diagnostics are returned in `MSE@Misc$Converge`. If 
+#' `control$SinglePrecision` is `TRUE`, the at-age projection arrays are stored 
+#' in single precision, which halves the memory used by the projections.
+#' If `control$Lean` is `TRUE`, the at-age projection arrays are not kept. Only 
+#' the totals used for the results and the years since the last update of the 
+#' Data object are stored, so the memory does not increase with the number of 
+#' projection years.
 #' 
 #' @templateVar url running-the-mse
 #' @templateVar ref NULL 
@@ -78,7 +104,7 @@ if(getRversion() >= "2.15.1") utils::globalVariables(Names)
 #' @return An object of class \linkS4class{MSE}
 #' @author T. Carruthers and A. Hordyk
 #' @describeIn runMSE Default function to use.
-#' @seealso \link{joinMSE} \link{checkMSE} \link{updateMSE}
+#' @seealso \link{joinMSE} \link{checkMSE} \link{updateMSE} \link{resumeMSE}
 #' @export
 runMSE <- function(OM = DLMtool::testOM, MPs = c("AvC","DCAC","FMSYref","curE","matlenlim", "MRreal"), 
                    CheckMPs = FALSE, timelimit = 1, Hist=FALSE, ntrials=100, fracD=0.05, CalcBlow=TRUE, 
@@ -119,8 +145,11 @@ runMSE <- function(OM = DLMtool::testOM, MPs = c("AvC","DCAC","FMSYref","curE","
     }
   }
 
-  if (parallel) {
-    if (OM@nsim<48) stop("nsim must be >=48 for parallel processing", call.=FALSE)
+  parallelMPs <- identical(parallel, "MPs")
+  if (!is.logical(parallel) && !parallelMPs) 
+    stop("parallel must be TRUE, FALSE, or 'MPs'", call.=FALSE)
+  
+  if (isTRUE(parallel) || parallelMPs) {
     if(!snowfall::sfIsRunning()) {
       # stop("Parallel processing hasn't been initialized. Use 'setup'", call. = FALSE)
       message("Parallel processing hasn't been initialized. Calling 'setup()' now")
@@ -150,93 +179,76 @@ runMSE <- function(OM = DLMtool::testOM, MPs = c("AvC","DCAC","FMSYref","curE","
       for (pk in extra_package)
         sfLibrary(pk, character.only = TRUE, verbose=FALSE)
     }
-
-    ncpu <- snowfall::sfCpus()
-    nits <- ceiling(OM@nsim/48)
-    
-    itsim <- rep(48,nits)
-    
-    if (nits < ncpu) {
-      if (nits < 4) {
-        nits <- 4
-        itsim <- rep(ceiling(OM@nsim/4), 4)
-      } else{
-        nits <- ncpu
-        itsim <- rep(ceiling(OM@nsim/ncpu), ncpu)
-      }
-     
-    }
-    cnt <- 1
-    while(sum(itsim) != OM@nsim | any(itsim<2)) {
-      diff <-  OM@nsim - sum(itsim)
-      if (diff >0) {
-        itsim[cnt] <- itsim[cnt]+1
-      } 
-      if(diff < 0) {
-        itsim[cnt] <- itsim[cnt]-1
-      }
-      cnt <- cnt+1 
-      if (cnt > length(itsim)) cnt <- 1 
-    }
-    
-   
-    if (!silent & !Hist) message("Running MSE in parallel on ", ncpu, ' processors')
-    if (!silent & Hist) message("Running historical simulations in parallel on ", ncpu, ' processors')
-   
-    temp <- snowfall::sfClusterApplyLB(1:nits, run_parallel, itsim=itsim, OM=OM, MPs=MPs,  
-                             CheckMPs=CheckMPs, timelimit=timelimit, Hist=Hist, ntrials=ntrials, 
-                             fracD=fracD, CalcBlow=CalcBlow, 
-                             HZN=HZN, Bfrac=Bfrac, AnnualMSY=AnnualMSY, silent=TRUE, PPD=PPD,
-                             control=control, parallel=parallel)
-    #assign_DLMenv() # grabs objects from DLMenv in cores, then merges and assigns to 'home' environment
-    
-    if (!is.null(save_name) && is.character(save_name)) saveRDS(temp, paste0(save_name, '.rdata'))
-
-    MSE1 <- joinMSE(temp) 
-    if (class(MSE1) == "MSE") {
-      if (!silent) message("MSE completed")
-    } else if (class(MSE1) == "Hist"){
-      if (!silent) message("Historical simulations completed")
-    } else {
-      warning("MSE completed but could not join MSE objects. Re-run with `save_name ='MyName'` to debug")
-    }
-  }
-
- 
-  if (!parallel) {
-    if (OM@nsim > 48 & !silent & !Hist) message("Suggest using 'parallel = TRUE' for large number of simulations")
-    MSE1 <- runMSE_int(OM, MPs, CheckMPs, timelimit, Hist, ntrials, fracD, CalcBlow, 
-                       HZN, Bfrac, AnnualMSY, silent, PPD, checks=checks, control=control)
   }
   
-  if (class(MSE1) == "MSE") {
-    # list in sequential mode
-    if (class(MSE1@Misc$TryMP) == "list") {
-      ok <- unlist(MSE1@Misc$TryMP) == "Okay"
-      fail <- unlist(MSE1@Misc$TryMP)
-    }
-      
-    if (class(MSE1@Misc$TryMP) == "matrix") {
-      ok <- colSums(MSE1@Misc$TryMP == "Okay") == nrow(MSE1@Misc$TryMP)
-      fail <- t(MSE1@Misc$TryMP)
-      if (any(grepl("could not find function", unique(fail[!ok,])))) {
-        warning("MPs may have been dropped because of non-exported functions in parallel mode. \nUse `setup(); snowfall::sfExport('FUNCTION1', 'FUNCTION2')` to export functions to cores")
-      }
-    }
-      
-    if (any(!ok)) {
-      failedMPs <- MSE1@MPs[!ok]
-      warning("Dropping failed MPs: ", paste(failedMPs, collapse=", "),"\n\nSee MSE@Misc$TryMP for error messages\n\n")
+  if (!isTRUE(parallel) && !parallelMPs && OM@nsim > 48 & !silent & !Hist) 
+    message("Suggest using 'parallel = TRUE' for large number of simulations")
+  MSE1 <- runMSE_int(OM, MPs, CheckMPs, timelimit, Hist, ntrials, fracD, CalcBlow, 
+                     HZN, Bfrac, AnnualMSY, silent, PPD, checks=checks, control=control,
+                     parallel=parallel)
+  if (isTRUE(parallel) && !is.null(save_name) && is.character(save_name)) 
+    saveRDS(MSE1, paste0(save_name, '.rdata'))
+  
+  if (class(MSE1) == "MSE") MSE1 <- dropFailedMPs(MSE1)
+  return(MSE1)
+}
 
-      if (length(failedMPs) == MSE1@nMPs) {
-        warning("All MPs failed.")
-        return(MSE1)
-      }
-      MSE1 <- Sub(MSE1, MPs=MSE1@MPs[!MSE1@MPs%in% failedMPs])  
+
+#' Resume an interrupted MSE
+#' 
+#' Continues a run of \link{runMSE} that was started with 
+#' `control=list(checkpoint='path/to/directory')` and was interrupted before
+#' it completed. The historical simulations are loaded from the checkpoint 
+#' directory and only the projections that had not been completed are run.
+#' 
+#' @param checkpoint Path to the checkpoint directory used in `runMSE`
+#' @param parallel Logical or character. Should the remaining projections be run 
+#' using parallel processing? See \link{runMSE}
+#' @param silent Should messages be printed out to the console?
+#' 
+#' @return An object of class \linkS4class{MSE}
+#' @details The checkpoint directory is not deleted when the MSE is completed.
+#' Custom MPs and any functions they use must be loaded before calling 
+#' `resumeMSE`.
+#' @author A. Hordyk
+#' @seealso \link{runMSE}
+#' @examples 
+#' \dontrun{
+#' MSE <- runMSE(control=list(checkpoint='MyMSE'))
+#' # if runMSE was interrupted:
+#' MSE <- resumeMSE('MyMSE')
+#' }
+#' @export
+resumeMSE <- function(checkpoint, parallel=FALSE, silent=FALSE) {
+  statefile <- file.path(checkpoint, "runMSE_state.rds")
+  if (!file.exists(statefile)) stop("No runMSE checkpoint found in ", checkpoint, call.=FALSE)
+  state <- readRDS(statefile)
+  
+  # the directory may have been moved since the run was started
+  state$checkpoint <- checkpoint
+  state$store$bin <- file.path(checkpoint, basename(state$store$bin))
+  state$store$rds <- file.path(checkpoint, basename(state$store$rds))
+  
+  parallelMPs <- identical(parallel, "MPs")
+  if (!is.logical(parallel) && !parallelMPs) 
+    stop("parallel must be TRUE, FALSE, or 'MPs'", call.=FALSE)
+  if (isTRUE(parallel) || parallelMPs) {
+    if(!snowfall::sfIsRunning()) {
+      message("Parallel processing hasn't been initialized. Calling 'setup()' now")
+      setup()
     }
-    
+    globalMP <- state$MPs[state$MPs %in% ls(globalenv())]
+    if (length(globalMP) > 0) {
+      message("Exporting custom MPs in global environment")
+      snowfall::sfExport(list=globalMP)
+    } 
   }
-  return(MSE1)
+  
+  HistList <- readHistStore(state$store)
+  on.exit(dropHistStore(state$store))
+  MSE1 <- runProjections(HistList, state$MPs, state$CB, state$FM, state$Misc, 
+                         parallel=parallel, silent=silent, state=state)
+  dropFailedMPs(MSE1)
 }
 
 
@@ -375,40 +387,9 @@ runMSE_int <- function(OM = DLMtool::testOM, MPs = c("AvC","DCAC","FMSYref","cur
     N[SAYR] <- R0[S] * surv[SA] * Pinitdist[SR]  # Calculate initial stock numbers
     Neq <- N
     SSB[SAYR] <- SSN[SAYR] * Wt_age[SAY]    # Calculate spawning stock biomass
-    SSB0 <- apply(SSB[, , 1, ], 1, sum)  # Calculate unfished spawning stock biomass
-    SSBpR <- matrix(SSB0/R0, nrow=nsim, ncol=nareas)  # Spawning stock biomass per recruit
-    SSB0a <- apply(SSB[, , 1, ], c(1, 3), sum)  # Calculate unfished spawning stock numbers
-    
-    bR <- matrix(log(5 * hs)/(0.8 * SSB0a), nrow=nsim)  # Ricker SR params
-    aR <- matrix(exp(bR * SSB0a)/SSBpR, nrow=nsim)  # Ricker SR params
-    R0a <- matrix(R0, nrow=nsim, ncol=nareas, byrow=FALSE) * 1/nareas # initial distribution of recruits
-    
-    # Project unfished for Nyrs to calculate equilibrium spatial distribution
-    Nyrs <- ceiling(3 * maxage) # Project unfished for 3 x maxage
-    # Set up projection arrays 
-    M_ageArrayp <- array(M_ageArray[,,1], dim=c(dim(M_ageArray)[1:2], Nyrs))
-    Wt_agep <- array(Wt_age[,,1], dim=c(dim(Wt_age)[1:2], Nyrs))
-    Mat_agep <- array(Mat_age[,,1], dim=c(dim(Mat_age)[1:2], Nyrs))
-    Perr_yp <- array(1, dim=c(dim(Perr_y)[1], Nyrs+maxage)) # no process error 
-    
-    # update mov if needed
-    dimMov <- dim(mov)
-    movp <- mov
-    if (dimMov[length(dimMov)] < Nyrs) {
-      movp <- array(movp, dim=c(dimMov[1:(length(dimMov)-1)], Nyrs))
-    }
 
-    # Not used but make the arrays anyway
-    retAp <- array(retA[,,1], dim=c(dim(retA)[1:2], Nyrs))
-    Vp <- array(V[,,1], dim=c(dim(V)[1:2], Nyrs))
-    noMPA <- matrix(1, nrow=Nyrs, ncol=nareas)
-    
-    runProj <- lapply(1:nsim, projectEq, Asize, nareas=nareas, maxage=maxage, N=N, pyears=Nyrs,
-           M_ageArray=M_ageArrayp, Mat_age=Mat_agep, Wt_age=Wt_agep, V=Vp, retA=retAp,
-           Perr=Perr_yp, mov=movp, SRrel=SRrel, Find=Find, Spat_targ=Spat_targ, hs=hs,
-           R0a=R0a, SSBpR=SSBpR, aR=aR, bR=bR, SSB0=SSB0, B0=B0, MPA=noMPA, maxF=maxF,
-           Nyrs)
-    Neq1 <- aperm(array(as.numeric(unlist(runProj)), dim=c(maxage, nareas, nsim)), c(3,1,2))  # unpack the list 
+    # Unfished equilibrium spatial distribution
+    Neq1 <- unfishedEq(N, M_ageArray, Wt_age, Mat_age, mov, R0)
   
     # --- Equilibrium spatial / age structure (initdist by SAR)
     initdist <- Neq1/array(apply(Neq1, c(1,2), sum), dim=c(nsim, maxage, nareas))
@@ -417,12 +398,6 @@ runMSE_int <- function(OM = DLMtool::testOM, MPs = c("AvC","DCAC","FMSYref","cur
     if (checks) {
       if(!all(round(apply(initdist, c(1,2), sum),1)==1)) warning('initdist does not sum to one')
       if(!(all(round(apply(Neq[,,1,], 1, sum) /  apply(Neq1, 1, sum),1) ==1))) warning('eq age structure')
-      sim <- sample(1:nsim,1)
-      yrval <- sample(1:Nyrs,1)
-      if (!all(M_ageArrayp[sim,,yrval] == M_ageArray[sim,,1] )) warning('problem with M_ageArrayp')
-      if(!all(Wt_agep[sim,,yrval] == Wt_age[sim,,1]))  warning('problem with Wt_agep')
-      if(!all(Mat_agep[sim,,yrval] == Mat_age[sim,,1])) warning('problem with Mat_agep')
-
     } 
   }
  
@@ -499,9 +474,7 @@ runMSE_int <- function(OM = DLMtool::testOM, MPs = c("AvC","DCAC","FMSYref","cur
   initD <- SampCpars$initD # 
   if (!is.null(initD)) { # initial depletion is not unfished
     if (!silent) message("Optimizing for user-specified depletion in first historical year")
-    Perrmulti <- sapply(1:nsim, optDfunwrap, initD=initD, Nfrac=Nfrac[,,1], R0=R0,
-                        Perr_y=Perr_y, surv=surv[,,1], Wt_age=Wt_age, SSB0=SSB0,
-                        maxage=maxage)
+    Perrmulti <- initDmulti(initD, Nfrac, R0, Perr_y, Wt_age, SSB0, maxage)
     Perr_y[,1:maxage] <- Perr_y[, 1:maxage] * Perrmulti
   }
   
@@ -624,7 +597,7 @@ runMSE_int <- function(OM = DLMtool::testOM, MPs = c("AvC","DCAC","FMSYref","cur
   histYrs <- sapply(1:nsim, function(x) 
     popdynCPP(nareas, maxage, Ncurr=N[x,,1,], nyears,  
               M_age=M_ageArray[x,,], Asize_c=Asize[x,], MatAge=Mat_age[x,,], WtAge=Wt_age[x,,],
-              Vuln=V[x,,], Retc=retA[x,,], Prec=Perr_y[x,], movc=split.along.dim(mov[x,,,,],4), 
+              Vuln=V[x,,], Retc=retA[x,,], Prec=Perr_y[x,], movc=movList(mov, x), 
               SRrelc=SRrel[x], 
               Effind=Find[x,],  Spat_targc=Spat_targ[x], hc=hs[x], R0c=R0a[x,], 
               SSBpRc=SSBpR[x,], aRc=aR[x,], bRc=bR[x,], Qc=qs[x], Fapic=0, MPA=MPA, maxF=maxF, 
@@ -712,21 +685,15 @@ runMSE_int <- function(OM = DLMtool::testOM, MPs = c("AvC","DCAC","FMSYref","cur
   if(CalcBlow){
     if(!silent) message("Calculating B-low reference points")            
     MGThorizon<-floor(HZN*MGT)
-    Blow <- sapply(1:nsim,getBlow, N, Asize, SSBMSY,SSBpR, MPA, SSB0, nareas, retA, MGThorizon,
-                   Find,Perr_y,M_ageArray,hs,Mat_age, Wt_age,R0a,V,nyears,maxage,mov,
-                   Spat_targ,SRrel,aR,bR,Bfrac, maxF) 
+    Blow <- getBlowCPP(N, Asize, SSBMSY, SSBpR, MPA, MGThorizon, Find, Perr_y, M_ageArray, 
+                       hs, Mat_age, Wt_age, R0a, V, mov, Spat_targ, SRrel, aR, bR, Bfrac, 
+                       maxF, plusgroup=0) # as getBlow, which was called without a plus-group
   }
 
   # --- Calculate Reference Yield ----
   if(!silent) message("Calculating reference yield - best fixed F strategy")  
-  RefY <- sapply(1:nsim, getFref3, Asize, nareas, maxage, N=N[,,nyears,, drop=FALSE], pyears=proyears, 
-                 M_ageArray=M_ageArray[,,(nyears):(nyears+proyears)], Mat_age[,,(nyears):(nyears+proyears)], 
-                 Wt_age=Wt_age[,,nyears:(nyears+proyears)], 
-                 V=V[, , (nyears + 1):(nyears + proyears), drop=FALSE], 
-                 retA=retA[, , (nyears + 1):(nyears + proyears), drop=FALSE],  
-                 Perr=Perr_y[,(nyears):(nyears+maxage+proyears-1)], mov, SRrel, Find, 
-                 Spat_targ, hs, R0a, SSBpR, aR, bR, MPA=MPA, maxF=maxF, SSB0=SSB0,
-                 plusgroup=plusgroup)
+  RefY <- getRefYCPP(N, Asize, M_ageArray, Mat_age, Wt_age, V, Perr_y, mov, MPA, SRrel, 
+                     Spat_targ, hs, R0a, SSBpR, aR, bR, proyears, maxF, plusgroup)
 
   RefPoints <- data.frame(MSY=MSY, FMSY=FMSY, SSBMSY=SSBMSY, SSBMSY_SSB0=SSBMSY_SSB0,
                          BMSY_B0=BMSY_B0, BMSY=BMSY, VBMSY=VBMSY, UMSY=UMSY, VBMSY_VB0=VBMSY_VB0,
@@ -837,13 +804,6 @@ runMSE_int <- function(OM = DLMtool::testOM, MPs = c("AvC","DCAC","FMSYref","cur
   nMP <- length(MPs)  # the total number of methods used
   if (nMP < 1) stop("No valid MPs found", call.=FALSE)
   
-  # --- Add nMP dimension to MSY stats  ----
-  MSY_y <- array(MSY_y, dim=c(nsim, nyears+proyears, nMP)) %>% aperm(c(1,3,2)) # store MSY for each sim, MP and year
-  FMSY_y <- array(FMSY_y, dim=c(nsim, nyears+proyears, nMP)) %>% aperm(c(1,3,2)) # store FMSY for each sim, MP and year
-  SSBMSY_y <- array(SSBMSY_y, dim=c(nsim, nyears+proyears, nMP)) %>% aperm(c(1,3,2)) # store SSBMSY for each sim, MP and year 
-  BMSY_y <- array(BMSY_y, dim=c(nsim, nyears+proyears, nMP)) %>% aperm(c(1,3,2)) # store BMSY for each sim, MP and year
-  VBMSY_y <- array(VBMSY_y, dim=c(nsim, nyears+proyears, nMP)) %>% aperm(c(1,3,2)) # store VBMSY for each sim, MP and year 
-
   # Calculate management interval for each MP
   if (length(interval) != nMP) interval <- rep(interval, nMP)[1:nMP]
   if (!all(interval == interval[1])) {
@@ -852,435 +812,770 @@ runMSE_int <- function(OM = DLMtool::testOM, MPs = c("AvC","DCAC","FMSYref","cur
     message(paste(capture.output(print(df)), collapse = "\n"))
   }
   
-  # ---- Set-up arrays and objects for projections ----
-  MSElist <- list(Data)[rep(1, nMP)]  # create a data object for each method (they have identical historical data and branch in projected years)
-  B_BMSYa <- array(NA, dim = c(nsim, nMP, proyears))  # store the projected B_BMSY
-  F_FMSYa <- array(NA, dim = c(nsim, nMP, proyears))  # store the projected F_FMSY
-  Ba <- array(NA, dim = c(nsim, nMP, proyears))  # store the projected Biomass
-  SSBa <- array(NA, dim = c(nsim, nMP, proyears))  # store the projected SSB
-  VBa <- array(NA, dim = c(nsim, nMP, proyears))  # store the projected vulnerable biomass
-  FMa <- array(NA, dim = c(nsim, nMP, proyears))  # store the projected fishing mortality rate
-  Ca <- array(NA, dim = c(nsim, nMP, proyears))  # store the projected removed catch
-  CaRet <- array(NA, dim = c(nsim, nMP, proyears))  # store the projected retained catch
-  TACa <- array(NA, dim = c(nsim, nMP, proyears))  # store the projected TAC recommendation
-  Effort <- array(NA, dim = c(nsim, nMP, proyears))  # store the Effort
-  PAAout <- array(NA, dim = c(nsim, nMP, maxage))  # store the population-at-age in last projection year
-  CAAout <- array(NA, dim = c(nsim, nMP, maxage))  # store the catch-at-age in last projection year
-  CALout <- array(NA, dim = c(nsim, nMP, nCALbins))  # store the population-at-length in last projection year
-  # SPRa <- array(NA,dim=c(nsim,nMP,proyears)) # store the Spawning Potential Ratio
-  
-  Cost_out <- array(NA, dim = c(nsim, nMP, proyears))  # store Total Cost
-  Rev_out <- array(NA, dim = c(nsim, nMP, proyears))  # store Total Revenue
-  LatEffort_out<- array(NA, dim = c(nsim, nMP, proyears))  # store the Latent Effort
-  TAE_out <- array(NA, dim = c(nsim, nMP, proyears)) # store the TAE
-  
-  # --- Begin loop over MPs ----
-  mm <- 1 # for debugging
-  Misc$TryMP <- list()
-  for (mm in 1:nMP) {  # MSE Loop over methods
-    tryMP <- try({
-      if(!silent) message(mm, "/", nMP, " Running MSE for ", MPs[mm]) 
-      checkNA <- rep(0, OM@proyears) # save number of NAs
+  # --- Historical objects used in the projections ----
+  # read-only; shared by all MPs
+  HistList <- mget(ProjObjects())
+  
+  runProjections(HistList, MPs, CB=CB, FM=FM, Misc=Misc, parallel=parallel, 
+                 silent=silent)
+}
 
-      # years management is updated
-      upyrs <- seq(from=1, to=proyears, by=interval[mm]) # 1 + (0:(floor(proyears/interval[mm]) - 1)) * interval[mm] 
+#' Run the projections for all MPs 
+#'
+#' Internal function of runMSE that runs the projections for all MPs from the 
+#' historical simulations and returns an object of class MSE. The projections 
+#' are split into tasks (a block of simulations for one MP). If 
+#' `control$checkpoint` is the path to a directory, the historical simulations
+#' and the result of each task are saved there as the run progresses, and 
+#' an interrupted run can be continued with \link{resumeMSE}.
+#'
+#' @param HistList Named list of the historical objects (see `ProjObjects`)
+#' @param MPs Character vector of MP names
+#' @param CB Historical catch-at-age array
+#' @param FM Historical fishing mortality-at-age array
+#' @param Misc List of miscellaneous output from the historical simulations
+#' @param parallel Logical or `'MPs'`. See \link{runMSE}
+#' @param silent Logical. Hide progress messages?
+#' @param state Saved state of a checkpointed run. Used by `resumeMSE`
+#'
+#' @return An object of class \linkS4class{MSE}
+#' @keywords internal
+runProjections <- function(HistList, MPs, CB, FM, Misc, parallel=FALSE, silent=FALSE,
+                           state=NULL) {
+  nsim <- HistList$nsim
+  nyears <- HistList$nyears
+  proyears <- HistList$proyears
+  maxage <- HistList$maxage
+  nCALbins <- HistList$nCALbins
+  CAL_binsmid <- HistList$CAL_binsmid
+  PPD <- HistList$PPD
+  control <- HistList$control
+  OM <- HistList$OM
+  Data <- HistList$Data
+  SSB <- HistList$SSB
+  nMP <- length(MPs)
+  parallelMPs <- identical(parallel, "MPs")
+  checkpoint <- control$checkpoint
+  
+  # MSE object for the simulations `sims`
+  makeMSE <- function(Results, sims, Misc) {
+    subsims <- function(x) x[sims, , , , drop=FALSE]
+    if (length(sims) == nsim) subsims <- identity
+    if (dim(Results$B_BMSY)[1] > length(sims)) 
+      Results <- lapply(Results, function(x) x[sims, , , drop=FALSE])
+    new("MSE", Name = OM@Name, nyears, proyears, nMPs=nMP, MPs, length(sims), 
+        Data@OM[sims, , drop=FALSE], Obs=Data@Obs[sims, , drop=FALSE], 
+        B_BMSY=Results$B_BMSY, F_FMSY=Results$F_FMSY, B=Results$B, SSB=Results$SSB, 
+        VB=Results$VB, FM=Results$FM, Results$CRet, TAC=Results$TAC, 
+        SSB_hist = subsims(SSB), CB_hist = subsims(CB), FM_hist = subsims(FM), 
+        Effort = Results$Effort, PAA=Results$PAA, CAA=Results$CAA, CAL=Results$CAL, 
+        CALbins=CAL_binsmid, Misc = Misc)
+  }
+  
+  conv <- NULL
+  if (!is.null(control$converge)) {
+    if (!is.null(checkpoint) || !is.null(state)) 
+      stop("`control$converge` can not be used with `control$checkpoint`", call.=FALSE)
+    conv <- initConvergence(control$converge, nsim, MPs)
+  }
+  
+  # ---- Set-up arrays and objects for projections ----
+  MSElist <- list()  # the Data object for each method (identical historical data that branch in projected years)
+  # projection results - in memory or written to disk as each MP finishes
+  ResDims <- ProjResultDims(nsim, nMP, proyears, maxage, nCALbins)
+  if (is.null(control$ResultStore)) {
+    Results <- lapply(ResDims, function(dd) array(NA, dim=dd))
+  } else {
+    rstore <- initResultStore(control$ResultStore, ResDims)
+    on.exit(closeResultStore(rstore), add=TRUE)
+  }
+  
+  # --- Tasks (block of simulations x MP) ----
+  if (!is.null(state)) {
+    # resume a checkpointed run 
+    checkpoint <- state$checkpoint
+    simblocks <- state$simblocks
+    store <- state$store
+    RNGstart <- state$RNG
+  } else {
+    if (!is.null(conv)) {
+      # blocks of simulations in order, so convergence can be checked as they finish
+      units <- SeedUnits(nsim)
+      simblocks <- lapply(split(units, ceiling(cumsum(lengths(units))/conv$block)), 
+                          unlist, use.names=FALSE)
+    } else if (isTRUE(parallel)) {
+      simblocks <- SimBlocks(nsim, nMP, snowfall::sfCpus(), control$SimBlock)
+    } else {
+      simblocks <- list(1:nsim)
+    }
+    if (!is.null(checkpoint)) {
+      # save the historical simulations and everything else needed to resume
+      statefile <- file.path(checkpoint, "runMSE_state.rds")
+      if (!dir.exists(checkpoint)) dir.create(checkpoint, recursive=TRUE)
+      if (file.exists(statefile)) 
+        stop("Checkpoint directory already contains a run: ", checkpoint, 
+             ". Use `resumeMSE` to continue it or choose a different directory", call.=FALSE)
+      store <- writeHistStore(HistList, dir=checkpoint, id="HistStore")
+      # the random number stream at the start of the projections, for the first task
+      RNGstart <- get0(".Random.seed", envir=globalenv())
+      saveRDS(list(checkpoint=checkpoint, store=store, MPs=MPs, CB=CB, FM=FM, 
+                   Misc=Misc, simblocks=simblocks, RNG=RNGstart), statefile)
+    } else if (isTRUE(parallel) || parallelMPs) {
+      # publish the historical simulations to the cores 
+      store <- writeHistStore(HistList, dir=control$StoreDir)
+      on.exit(clearHistStore(store), add=TRUE)
+    }
+  }
+  tasks <- expand.grid(bl=seq_along(simblocks), mm=1:nMP)
+  done <- rep(FALSE, nrow(tasks))
+  if (!is.null(checkpoint)) {
+    done <- file.exists(TaskFile(checkpoint, tasks))
+    if (any(done) && !silent) 
+      message("Resuming from checkpoint: ", sum(done), " of ", nrow(tasks), " tasks completed")
+  }
+  
+  # tasks are run in waves of simulation blocks when tracking convergence,
+  # otherwise all at once
+  waves <- list(seq_len(nrow(tasks)))
+  if (!is.null(conv)) {
+    nwave <- 1
+    if (isTRUE(parallel) || parallelMPs) nwave <- max(1, ceiling(snowfall::sfCpus()/nMP))
+    waves <- split(seq_len(nrow(tasks)), ceiling(tasks$bl/nwave))
+  }
+  
+  if ((isTRUE(parallel) || parallelMPs) && any(!done)) {
+    # tasks are handed out to the cores as they become free 
+    if (!is.null(checkpoint)) on.exit(clearHistStore(store, unlink=FALSE), add=TRUE)
+    if(!silent) message("Running projections for ", nMP, " MPs in ", sum(!done),
+                        " tasks in parallel on ", snowfall::sfCpus(), " processors")
+  }
+  
+  if (length(simblocks) > 1) {
+    Misc$TryMP <- matrix("Okay", nrow=length(simblocks), ncol=nMP)
+  } else {
+    Misc$TryMP <- list()
+  }
+  TaskRun <- vector("list", nrow(tasks))
+  PPDblocks <- vector("list", nrow(tasks))
+  failedTask <- ran <- rep(FALSE, nrow(tasks))
+  RNGstate <- NULL
+  if (!is.null(checkpoint)) RNGstate <- RNGstart
+  for (wave in waves) {
+    run <- wave[!done[wave]]
+    if ((isTRUE(parallel) || parallelMPs) && length(run) > 0) {
+      TaskRun[run] <- snowfall::sfClusterApplyLB(run, projectTask_par, 
+                                                 tasks=tasks, simblocks=simblocks, 
+                                                 MPs=MPs, store=store, seed=OM@seed,
+                                                 checkpoint=checkpoint)
+    } else if (length(simblocks) > 1) {
+      HistBlocks <- list()
+      for (bl in unique(tasks$bl[run])) 
+        HistBlocks[[bl]] <- SubHistList(HistList, simblocks[[bl]])
+    } else {
+      HistBlocks <- list(HistList)
+    }
+    
+    for (mm in unique(tasks$mm[wave])) {  # MSE Loop over methods
+      ind <- wave[tasks$mm[wave] == mm]
+      MPout <- lapply(ind, function(tt) {
+        if (!is.null(checkpoint) && (done[tt] || isTRUE(parallel) || parallelMPs)) {
+          saved <- readRDS(TaskFile(checkpoint, tasks[tt,]))
+          RNGstate <<- saved$RNG
+          return(saved$MPout)
+        }
+        if (isTRUE(parallel) || parallelMPs) return(TaskRun[[tt]])
+        # sequential - continue the random number stream from the previous task
+        if (!is.null(RNGstate)) assign(".Random.seed", RNGstate, envir=globalenv())
+        out <- projectMP(mm, MPs, HistBlocks[[tasks$bl[tt]]], silent=silent)
+        RNGstate <<- get(".Random.seed", envir=globalenv())
+        if (!is.null(checkpoint)) saveTask(out, RNGstate, TaskFile(checkpoint, tasks[tt,]))
+        out
+      })
+      TaskRun[ind] <- list(NULL)
       
-      # reset selectivity & retention parameters for projections
-      L5_P <- L5  
-      LFS_P <- LFS
-      Vmaxlen_P <- Vmaxlen
-      SLarray_P <- SLarray # selectivity at length array - projections
-      V_P <- V  #  selectivity at age array - projections
-      LR5_P <- LR5
-      LFR_P <- LFR
-      Rmaxlen_P <- Rmaxlen
-      retA_P <- retA # retention at age array - projections
-      retL_P <- retL # retention at length array - projections
-      Fdisc_P <- Fdisc # Discard mortality for projectons 
-      DR_P <- DR # Discard ratio for projections
-      LatentEff_MP <- LatentEff # Historical latent effort
+      for (k in seq_along(ind)) {
+        ss <- simblocks[[tasks$bl[ind[k]]]]
+        if (is.null(control$ResultStore)) {
+          for (nm in names(Results)) Results[[nm]][ss, mm, ] <- MPout[[k]][[nm]]
+        } else {
+          writeResultStore(rstore, MPout[[k]], mm, ss)
+        }
+      }
       
-      # projection arrays
-      N_P <- array(NA, dim = c(nsim, maxage, proyears, nareas))
-      Biomass_P <- array(NA, dim = c(nsim, maxage, proyears, nareas))
-      VBiomass_P <- array(NA, dim = c(nsim, maxage, proyears, nareas))
-      SSN_P <-array(NA, dim = c(nsim, maxage, proyears, nareas))
-      SSB_P <- array(NA, dim = c(nsim, maxage, proyears, nareas))
-      FM_P <- array(NA, dim = c(nsim, maxage, proyears, nareas))
-      FM_Pret <- array(NA, dim = c(nsim, maxage, proyears, nareas)) # retained F 
-      Z_P <- array(NA, dim = c(nsim, maxage, proyears, nareas))
-      CB_P <- array(NA, dim = c(nsim, maxage, proyears, nareas))
-      CB_Pret <- array(NA, dim = c(nsim, maxage, proyears, nareas)) # retained catch 
+      tryMP <- lapply(MPout, "[[", "TryMP")
+      failed <- vapply(tryMP, inherits, logical(1), what="try-error")
+      if (any(failed) && !silent) 
+        message("Note: ", MPs[mm], " failed. Skipping this MP. \nSee `MSE@Misc$TryMP` for details")
+      if (length(simblocks) > 1) {
+        Misc$TryMP[tasks$bl[ind][failed], mm] <- vapply(tryMP[failed], as.character, character(1))
+      } else {
+        Misc$TryMP[[mm]] <- if (failed) tryMP[[1]] else "Okay"
+      }
+      failedTask[ind] <- failed
+      if (PPD) PPDblocks[ind] <- lapply(MPout, "[[", "Data")
+      ran[ind] <- TRUE
       
-      # indexes
-      SAYRL <- as.matrix(expand.grid(1:nsim, 1:maxage, nyears, 1:nareas))  # Final historical year
-      SAYRt <- as.matrix(expand.grid(1:nsim, 1:maxage, 1 + nyears, 1:nareas))  # Trajectory year
-      SAYR <- as.matrix(expand.grid(1:nsim, 1:maxage, 1, 1:nareas))
-      SYt <- SAYRt[, c(1, 3)]
-      SAYt <- SAYRt[, 1:3]
-      SR <- SAYR[, c(1, 4)]
-      SA1 <- SAYR[, 1:2]
-      S1 <- SAYR[, 1]
-      SY1 <- SAYR[, c(1, 3)]
-      SAY1 <- SAYRt[, 1:3]
-      SYA <- as.matrix(expand.grid(1:nsim, 1, 1:maxage))  # Projection year
-      SY <- SYA[, 1:2]
-      SA <- SYA[, c(1, 3)]
-      SAY <- SYA[, c(1, 3, 2)]
-      S <- SYA[, 1]
+      if (!isTRUE(parallel)) 
+        if("progress"%in%names(control))
+          if(control$progress) 
+            shiny::incProgress(length(ind)/nrow(tasks), detail = round(sum(ran)*100/nrow(tasks)))
       
-      # -- First projection year ----
-      y <- 1
+    }  # end of mm methods 
+    
+    if (!is.null(conv)) {
+      # update the running means of the performance metrics with the new simulations
+      sims <- unlist(simblocks[unique(tasks$bl[wave])])
+      if (is.null(control$ResultStore)) res <- Results else res <- readResultStore(rstore)
+      conv <- updateConvergence(conv, makeMSE(res, sims, list()))
+      if (conv$stop && all(conv$Converged)) {
+        if (!silent) message("Performance metrics converged after ", conv$n, 
+                             " simulations. Stopping projections")
+        break
+      }
+    }
+  }  # end of waves
+  
+  sims <- sort(unlist(simblocks[unique(tasks$bl[ran])]))
+  if (PPD) {
+    for (mm in 1:nMP) {
+      ind <- which(tasks$mm == mm & ran)
+      if (length(ind) > 1 && !any(failedTask[ind])) {
+        MSElist[mm] <- list(joinData(PPDblocks[ind]))
+      } else {
+        MSElist[mm] <- list(PPDblocks[[ind[1]]])
+      }
+    }
+  }
+  if (!is.null(conv)) {
+    Misc$Converge <- reportConvergence(conv)
+    if (!all(conv$Converged) && !silent) 
+      message("Performance metrics have not converged after ", conv$n, 
+              " simulations. See `MSE@Misc$Converge`")
+  }
+  
+  # Miscellaneous reporting
+  if(PPD) Misc$Data <- MSElist
+  if (!is.null(control$ResultStore)) {
+    Results <- readResultStore(rstore) # memory-mapped
+    Misc$ResultStore <- rstore$dir
+  }
+  if (length(sims) < nsim) {
+    # projections stopped early when converged
+    Results <- lapply(Results, function(x) x[sims, , , drop=FALSE])
+    if (is.matrix(Misc$TryMP)) Misc$TryMP <- Misc$TryMP[unique(tasks$bl[ran]), , drop=FALSE]
+  }
+
+  # Report profit margin and latent effort
+  Misc$LatEffort <- Results$LatEffort
+  Misc$Revenue <- Results$Rev
+  Misc$Cost <- Results$Cost
+  Misc$TAE <- Results$TAE
+  Misc$PMcache <- new.env(parent=emptyenv()) # cache of performance metric statistics (see PMcalc)
+  
+  ## Create MSE Object #### 
+  MSEout <- makeMSE(Results, sims, Misc)
+  # Store MSE info
+  attr(MSEout, "version") <- packageVersion("DLMtool")
+  attr(MSEout, "date") <- date()
+  attr(MSEout, "R.version") <- R.version
+  
+  MSEout 
+}
+
+# Run one task (block of simulations x MP) on the cores. With a checkpoint 
+# directory the result is saved to disk instead of being returned 
+projectTask_par <- function(tt, tasks, simblocks, MPs, store, seed, checkpoint=NULL) {
+  sims <- simblocks[[tasks$bl[tt]]]
+  HistList <- readHistBlock(store, sims)
+  # each unit of simulations has its own random number seed, so the results do 
+  # not depend on how the simulations are divided into tasks
+  units <- SeedUnits(length(unlist(simblocks)))
+  mm <- tasks$mm[tt]
+  MPout <- lapply(which(vapply(units, function(u) all(u %in% sims), logical(1))), function(u) {
+    set.seed(seed + length(MPs) * (u-1) + mm)
+    projectMP(mm, MPs, HistList=SubHistList(HistList, match(units[[u]], sims)), silent=TRUE)
+  })
+  MPout <- joinMPout(MPout)
+  if (is.null(checkpoint)) return(MPout)
+  saveTask(MPout, get(".Random.seed", envir=globalenv()), TaskFile(checkpoint, tasks[tt,]))
+  NULL
+}
+
+# File name of the checkpoint for each task 
+TaskFile <- function(checkpoint, tasks) {
+  file.path(checkpoint, paste0("task_", tasks$mm, "_", tasks$bl, ".rds"))
+}
+
+# Save the result of a task and the state of the random number generator.
+# Written to a temporary file first so that an interrupted save is not 
+# mistaken for a completed task
+saveTask <- function(MPout, RNG, file) {
+  tmp <- paste0(file, ".tmp")
+  saveRDS(list(MPout=MPout, RNG=RNG), tmp)
+  file.rename(tmp, file)
+}
+
+# Drop MPs that failed from the MSE object
+dropFailedMPs <- function(MSE1) {
+  # list in sequential mode
+  if (is.list(MSE1@Misc$TryMP)) {
+    ok <- unlist(MSE1@Misc$TryMP) == "Okay"
+    fail <- unlist(MSE1@Misc$TryMP)
+  }
+    
+  if (is.matrix(MSE1@Misc$TryMP)) {
+    ok <- colSums(MSE1@Misc$TryMP == "Okay") == nrow(MSE1@Misc$TryMP)
+    fail <- t(MSE1@Misc$TryMP)
+    if (any(grepl("could not find function", unique(fail[!ok,])))) {
+      warning("MPs may have been dropped because of non-exported functions in parallel mode. \nUse `setup(); snowfall::sfExport('FUNCTION1', 'FUNCTION2')` to export functions to cores")
+    }
+  }
+    
+  if (any(!ok)) {
+    failedMPs <- MSE1@MPs[!ok]
+    warning("Dropping failed MPs: ", paste(failedMPs, collapse=", "),"\n\nSee MSE@Misc$TryMP for error messages\n\n")
+
+    if (length(failedMPs) == MSE1@nMPs) {
+      warning("All MPs failed.")
+      return(MSE1)
+    }
+    MSE1 <- Sub(MSE1, MPs=MSE1@MPs[!MSE1@MPs%in% failedMPs])  
+  }
+  MSE1
+}
+
+
+
+# Names of the objects created in runMSE_int that are required by projectMP
+ProjObjects <- function() {
+  c("OM", "nsim", "nyears", "proyears", "maxage", "nareas", "interval", "reps",
+    "pstar", "maxF", "plusgroup", "AnnualMSY", "PPD", "control", "Data", 
+    "StockPars", "FleetPars", "ObsPars", "SampCpars", "RefPoints", "ErrList",
+    "L5", "LFS", "Vmaxlen", "SLarray", "V", "LR5", "LFR", "Rmaxlen", "retA", 
+    "retL", "Fdisc", "DR", "LatentEff", "N", "SSB", "Z", "Biomass", "VBiomass",
+    "CBret", "Perr_y", "hs", "R0", "R0a", "SSBpR", "aR", "bR", "mov", "SRrel", 
+    "Wt_age", "Mat_age", "M_ageArray", "MPA", "RevCurr", "CostCurr", "Response", 
+    "CostInc", "RevInc", "TAC_f", "E_f", "SizeLim_f", "FinF", "Spat_targ", 
+    "CAL_binsmid", "Linf", "Len_age", "Asize", "nCALbins", "qs", "qvar", "qinc",
+    "MSY_y", "FMSY_y", "SSBMSY_y")
+}
+
+#' Project the population forward for a single MP
+#'
+#' Internal function of runMSE that runs the closed-loop projections for one 
+#' MP, starting from the historical simulations. 
+#'
+#' @param mm Index of the MP in `MPs`
+#' @param MPs Character vector of MP names
+#' @param HistList Named list of the historical objects (see `ProjObjects`)
+#' @param silent Logical. Hide progress messages?
+#'
+#' @return A named list with the projection results for the MP (each nsim by 
+#' proyears, or nsim by maxage/nCALbins for the at-age and at-length 
+#' output), the Data object from the last projection year (if `PPD=TRUE`),
+#' and `TryMP` which is either `NULL` or the error message if the MP failed.
+#' @keywords internal
+projectMP <- function(mm, MPs, HistList, silent=FALSE) {
+  for (X in 1:length(HistList)) assign(names(HistList)[X], HistList[[X]])
+  nMP <- length(MPs)
+  
+  # ---- Set-up arrays for this MP ----
+  B_BMSYa <- array(NA, dim = c(nsim, proyears))  # store the projected B_BMSY
+  F_FMSYa <- array(NA, dim = c(nsim, proyears))  # store the projected F_FMSY
+  Ba <- array(NA, dim = c(nsim, proyears))  # store the projected Biomass
+  SSBa <- array(NA, dim = c(nsim, proyears))  # store the projected SSB
+  VBa <- array(NA, dim = c(nsim, proyears))  # store the projected vulnerable biomass
+  FMa <- array(NA, dim = c(nsim, proyears))  # store the projected fishing mortality rate
+  CaRet <- array(NA, dim = c(nsim, proyears))  # store the projected retained catch
+  TACa <- array(NA, dim = c(nsim, proyears))  # store the projected TAC recommendation
+  Effort <- array(NA, dim = c(nsim, proyears))  # store the Effort
+  PAAout <- array(NA, dim = c(nsim, maxage))  # store the population-at-age in last projection year
+  CAAout <- array(NA, dim = c(nsim, maxage))  # store the catch-at-age in last projection year
+  CALout <- array(NA, dim = c(nsim, nCALbins))  # store the population-at-length in last projection year
+  
+  Cost_out <- array(NA, dim = c(nsim, proyears))  # store Total Cost
+  Rev_out <- array(NA, dim = c(nsim, proyears))  # store Total Revenue
+  LatEffort_out<- array(NA, dim = c(nsim, proyears))  # store the Latent Effort
+  TAE_out <- array(NA, dim = c(nsim, proyears)) # store the TAE
+  
+  MSEData <- Data # Data object for this MP - branches from historical data in projected years
+  DataStore <- initDataStore(MSEData, Biomass, ErrList, ObsPars, proyears) # projected data written in place
+  
+  tryMP <- try({
+    if(!silent) message(mm, "/", nMP, " Running MSE for ", MPs[mm]) 
+    checkNA <- rep(0, OM@proyears) # save number of NAs
+
+    # years management is updated
+    upyrs <- seq(from=1, to=proyears, by=interval[mm]) # 1 + (0:(floor(proyears/interval[mm]) - 1)) * interval[mm] 
+    
+    # reset selectivity & retention parameters for projections
+    L5_P <- L5  
+    LFS_P <- LFS
+    Vmaxlen_P <- Vmaxlen
+    SLarray_P <- SLarray # selectivity at length array - projections
+    V_P <- V  #  selectivity at age array - projections
+    LR5_P <- LR5
+    LFR_P <- LFR
+    Rmaxlen_P <- Rmaxlen
+    retA_P <- retA # retention at age array - projections
+    retL_P <- retL # retention at length array - projections
+    Fdisc_P <- Fdisc # Discard mortality for projectons 
+    DR_P <- DR # Discard ratio for projections
+    LatentEff_MP <- LatentEff # Historical latent effort
+    
+    # projection arrays - all years are written to the store (see initProjStore), 
+    # the *_P arrays are the current year (nsim, maxage, nareas)
+    ProjStore <- initProjStore(nsim, maxage, proyears, nareas, 
+                               single=isTRUE(control$SinglePrecision),
+                               lean=isTRUE(control$Lean), 
+                               byAge=if (length(ErrList$AddIerr)>0) "Biomass")
+    FM_P <- array(NA, dim = c(nsim, maxage, nareas))
+    FM_Pret <- array(NA, dim = c(nsim, maxage, nareas)) # retained F 
+    Z_P <- array(NA, dim = c(nsim, maxage, nareas))
+    CB_P <- array(NA, dim = c(nsim, maxage, nareas))
+    CB_Pret <- array(NA, dim = c(nsim, maxage, nareas)) # retained catch 
+    
+    # -- First projection year ----
+    y <- 1
+    if(!silent) {
+      cat("."); flush.console()
+    }
+    # Recruitment and movement in first year 
+    NextYrN <- lapply(1:nsim, function(x)
+      popdynOneTScpp(nareas, maxage, SSBcurr=colSums(SSB[x,,nyears, ]), Ncurr=N[x,,nyears,],
+                     Zcurr=Z[x,,nyears,], PerrYr=Perr_y[x, nyears+maxage-1], hs=hs[x],
+                     R0a=R0a[x,], SSBpR=SSBpR[x,], aR=aR[x,], bR=bR[x,],
+                     mov=mov[x,,,,movYr(mov, nyears+1)], SRrel=SRrel[x],
+                     plusgroup = plusgroup))
+    
+    # The stock at the beginning of projection period
+    N_P <- aperm(array(unlist(NextYrN), dim=c(maxage, nareas, nsim)), c(3,1,2))
+    Biomass_P <- N_P * Wt_age[,,nyears+y]  # Calculate biomass
+    VBiomass_P <- Biomass_P * V_P[,,nyears+y]  # Calculate vulnerable biomass
+    SSN_P <- N_P * Mat_age[,,nyears+y]  # Calculate spawning stock numbers
+    SSB_P <- SSN_P * Wt_age[,,nyears+y]
+    
+    # Update abundance estimates - used for FMSY ref methods so that FMSY is applied to current abundance
+    M_array <- array(0.5*M_ageArray[,,nyears+y], dim=c(nsim, maxage, nareas))
+    Atemp <- apply(VBiomass_P * exp(-M_array), 1, sum) # Abundance (mid-year before fishing)
+    MSEData@OM$A <- Atemp 
+    
+    # -- Apply MP in initial projection year ----
+    runMP <- applyMP(Data=MSEData, MPs = MPs[mm], reps = reps, silent=TRUE)  # Apply MP
+    MPRecs <- runMP[[1]][[1]] # MP recommendations
+    Data_p <- runMP[[2]] # Data object object with saved info from MP 
+    Data_p@TAC <- MPRecs$TAC
+    
+    LastSpatial <- array(MPA[nyears,], dim=c(nareas, nsim)) # 
+    LastAllocat <- rep(1, nsim) # default assumption of reallocation of effort to open areas
+    LastTAC <- LastCatch <- apply(CBret[,,nyears,], 1, sum)
+    
+    # calculate pstar quantile of TAC recommendation dist 
+    TACused <- apply(Data_p@TAC, 2, quantile, p = pstar, na.rm = T) 
+    if (length(MPRecs$TAC) >0) {
+      # a TAC has been recommended
+      checkNA[y] <- sum(is.na(TACused))
+      TACused[is.na(TACused)] <- LastTAC[is.na(TACused)] # set to last yr TAC if NA
+      TACa[, y] <- TACused # recommended TAC 
+    }
+    
+    # -- Bio-Economics ----
+    # Calculate Profit from last historical year
+    RevPC <- RevCurr/LastCatch # cost-per unit catch in last historical year
+    PMargin <- 1 - CostCurr/(RevPC * LastCatch) # profit margin in last historical year
+    Profit <- (RevPC * LastCatch) - CostCurr # profit in last historical year
+    HistEffort <- rep(1, nsim) # future effort is relative to today's effort
+    Effort_pot <- HistEffort + Response*Profit # potential effort in first projection year
+    Effort_pot[Effort_pot<0] <- tiny # 
+    
+    # Latent Effort - Maximum Effort Limit
+    if (!all(is.na(LatentEff_MP))) {
+      LastTAE <- histTAE <- HistEffort / (1 - LatentEff_MP) # current TAE limit exists    
+    } else {
+      LastTAE <- histTAE <- rep(NA, nsim) # no current TAE exists  
+    }
+
+    # -- Calc stock dynamics ----
+    MPCalcs <- CalcMPDynamics(MPRecs, y, nyears, proyears, nsim, Biomass_P, VBiomass_P,
+                              LastTAE, histTAE, LastSpatial, LastAllocat, LastTAC,
+                              TACused, maxF,
+                              LR5_P, LFR_P, Rmaxlen_P, retL_P, retA_P,
+                              L5_P, LFS_P, Vmaxlen_P, SLarray_P, V_P,
+                              Fdisc_P, DR_P,
+                              M_ageArray, FM_P, FM_Pret, Z_P, CB_P, CB_Pret,
+                              TAC_f, E_f, SizeLim_f,
+                              FinF, Spat_targ,
+                              CAL_binsmid, Linf, Len_age, maxage, nareas, Asize, nCALbins,
+                              qs, qvar, qinc, Effort_pot)
+
+    TACa[, y] <- MPCalcs$TACrec # recommended TAC 
+    LastSpatial <- MPCalcs$Si
+    LastAllocat <- MPCalcs$Ai
+    LastTAE <- MPCalcs$TAE # TAE set by MP 
+    LastTAC <- MPCalcs$TACrec # TAC et by MP
+    Effort[, y] <- MPCalcs$Effort  
+    CB_P <- MPCalcs$CB_P # removals
+    CB_Pret <- MPCalcs$CB_Pret # retained catch 
+    # apply(CB_Pret[,,1,], 1, sum)
+    FM_P <- MPCalcs$FM_P # fishing mortality
+    FM_Pret <- MPCalcs$FM_Pret # retained fishing mortality 
+    Z_P <- MPCalcs$Z_P # total mortality
+    retA_P <- MPCalcs$retA_P # retained-at-age
+    retL_P <- MPCalcs$retL_P # retained-at-length
+    V_P <- MPCalcs$V_P  # vulnerable-at-age
+    SLarray_P <- MPCalcs$SLarray_P # vulnerable-at-length
+    FMa[, y] <- MPCalcs$Ftot 
+    
+    # ---- Bio-economics ----
+    RetainCatch <- apply(CB_Pret, 1, sum) # retained catch this year
+    RetainCatch[RetainCatch<=0] <- tiny
+    Cost_out[, y] <-  Effort[, y] * CostCurr*(1+CostInc/100)^y # cost of effort this year
+    Rev_out[, y] <- (RevPC*(1+RevInc/100)^y * RetainCatch)
+    PMargin <- 1 - Cost_out[, y]/Rev_out[, y] # profit margin this year
+    Profit <- Rev_out[, y] - Cost_out[, y] # profit this year
+    Effort_pot <- Effort_pot + Response*Profit # bio-economic effort next year
+    Effort_pot[Effort_pot<0] <- tiny # 
+    LatEffort_out[, y] <- LastTAE - Effort[, y]  # store the Latent Effort
+    TAE_out[, y] <- LastTAE # store the TAE
+    setProjYear(ProjStore, y, N=N_P, Biomass=Biomass_P, VBiomass=VBiomass_P, 
+                SSN=SSN_P, SSB=SSB_P, FM=FM_P, FMret=FM_Pret, Z=Z_P, 
+                CB=CB_P, CBret=CB_Pret)
+    
+    # --- Begin projection years ----
+    for (y in 2:proyears) {
       if(!silent) {
         cat("."); flush.console()
       }
-      # Recruitment and movement in first year 
-      NextYrN <- lapply(1:nsim, function(x)
-        popdynOneTScpp(nareas, maxage, SSBcurr=colSums(SSB[x,,nyears, ]), Ncurr=N[x,,nyears,],
-                       Zcurr=Z[x,,nyears,], PerrYr=Perr_y[x, nyears+maxage-1], hs=hs[x],
-                       R0a=R0a[x,], SSBpR=SSBpR[x,], aR=aR[x,], bR=bR[x,],
-                       mov=mov[x,,,,nyears+1], SRrel=SRrel[x],
-                       plusgroup = plusgroup))
-      
-      # The stock at the beginning of projection period
-      N_P[,,1,] <- aperm(array(unlist(NextYrN), dim=c(maxage, nareas, nsim, 1)), c(3,1,4,2))
-      Biomass_P[SAYR] <- N_P[SAYR] * Wt_age[SAY1]  # Calculate biomass
-      VBiomass_P[SAYR] <- Biomass_P[SAYR] * V_P[SAYt]  # Calculate vulnerable biomass
-      SSN_P[SAYR] <- N_P[SAYR] * Mat_age[SAY1]  # Calculate spawning stock numbers
-      SSB_P[SAYR] <- SSN_P[SAYR] * Wt_age[SAY1]
       
-      # Update abundance estimates - used for FMSY ref methods so that FMSY is applied to current abundance
-      M_array <- array(0.5*M_ageArray[,,nyears+y], dim=c(nsim, maxage, nareas))
-      Atemp <- apply(VBiomass_P[, , y, ] * exp(-M_array), 1, sum) # Abundance (mid-year before fishing)
-      MSElist[[mm]]@OM$A <- Atemp 
-      
-      # -- Apply MP in initial projection year ----
-      runMP <- applyMP(Data=MSElist[[mm]], MPs = MPs[mm], reps = reps, silent=TRUE)  # Apply MP
-      MPRecs <- runMP[[1]][[1]] # MP recommendations
-      Data_p <- runMP[[2]] # Data object object with saved info from MP 
-      Data_p@TAC <- MPRecs$TAC
-      
-      LastSpatial <- array(MPA[nyears,], dim=c(nareas, nsim)) # 
-      LastAllocat <- rep(1, nsim) # default assumption of reallocation of effort to open areas
-      LastTAC <- LastCatch <- apply(CBret[,,nyears,], 1, sum)
+      SelectChanged <- FALSE
+      if (AnnualMSY) {
+        if (any(range(retA_P[,,nyears+y] - retA[,,nyears+y]) !=0)) SelectChanged <- TRUE
+        if (any(range(V_P[,,nyears+y] - V[,,nyears+y]) !=0))  SelectChanged <- TRUE
+      }
       
-      # calculate pstar quantile of TAC recommendation dist 
-      TACused <- apply(Data_p@TAC, 2, quantile, p = pstar, na.rm = T) 
-      if (length(MPRecs$TAC) >0) {
-        # a TAC has been recommended
-        checkNA[y] <- sum(is.na(TACused))
-        TACused[is.na(TACused)] <- LastTAC[is.na(TACused)] # set to last yr TAC if NA
-        TACa[, mm, y] <- TACused # recommended TAC 
+      # -- Calculate MSY stats for this year ----
+      if (AnnualMSY & SelectChanged) { #
+        y1 <- nyears + y
+        MSYrefsYr <- sapply(1:nsim, optMSY_eq, M_ageArray, Wt_age, Mat_age, 
+                            V_P, maxage, R0, SRrel, hs, yr.ind=y1)
+        MSY_y[, y] <- MSYrefsYr[1, ]
+        FMSY_y[, y] <- MSYrefsYr[2,]
+        SSBMSY_y[, y] <- MSYrefsYr[3,]
       }
       
-      # -- Bio-Economics ----
-      # Calculate Profit from last historical year
-      RevPC <- RevCurr/LastCatch # cost-per unit catch in last historical year
-      PMargin <- 1 - CostCurr/(RevPC * LastCatch) # profit margin in last historical year
-      Profit <- (RevPC * LastCatch) - CostCurr # profit in last historical year
-      HistEffort <- rep(1, nsim) # future effort is relative to today's effort
-      Effort_pot <- HistEffort + Response*Profit # potential effort in first projection year
-      Effort_pot[Effort_pot<0] <- tiny # 
+      TACa[, y] <- TACa[, y-1] # TAC same as last year unless changed 
       
-      # Latent Effort - Maximum Effort Limit
-      if (!all(is.na(LatentEff_MP))) {
-        LastTAE <- histTAE <- HistEffort / (1 - LatentEff_MP) # current TAE limit exists    
-      } else {
-        LastTAE <- histTAE <- rep(NA, nsim) # no current TAE exists  
-      }
-
-      # -- Calc stock dynamics ----
-      MPCalcs <- CalcMPDynamics(MPRecs, y, nyears, proyears, nsim, Biomass_P, VBiomass_P,
-                                LastTAE, histTAE, LastSpatial, LastAllocat, LastTAC,
-                                TACused, maxF,
-                                LR5_P, LFR_P, Rmaxlen_P, retL_P, retA_P,
-                                L5_P, LFS_P, Vmaxlen_P, SLarray_P, V_P,
-                                Fdisc_P, DR_P,
-                                M_ageArray, FM_P, FM_Pret, Z_P, CB_P, CB_Pret,
-                                TAC_f, E_f, SizeLim_f,
-                                FinF, Spat_targ,
-                                CAL_binsmid, Linf, Len_age, maxage, nareas, Asize, nCALbins,
-                                qs, qvar, qinc, Effort_pot)
-  
-      TACa[, mm, y] <- MPCalcs$TACrec # recommended TAC 
-      LastSpatial <- MPCalcs$Si
-      LastAllocat <- MPCalcs$Ai
-      LastTAE <- MPCalcs$TAE # TAE set by MP 
-      LastTAC <- MPCalcs$TACrec # TAC et by MP
-      Effort[, mm, y] <- MPCalcs$Effort  
-      CB_P <- MPCalcs$CB_P # removals
-      CB_Pret <- MPCalcs$CB_Pret # retained catch 
-      # apply(CB_Pret[,,1,], 1, sum)
-      FM_P <- MPCalcs$FM_P # fishing mortality
-      FM_Pret <- MPCalcs$FM_Pret # retained fishing mortality 
-      Z_P <- MPCalcs$Z_P # total mortality
-      retA_P <- MPCalcs$retA_P # retained-at-age
-      retL_P <- MPCalcs$retL_P # retained-at-length
-      V_P <- MPCalcs$V_P  # vulnerable-at-age
-      SLarray_P <- MPCalcs$SLarray_P # vulnerable-at-length
-      FMa[,mm,y] <- MPCalcs$Ftot 
+      # --- Age & Growth ----
+      NextYrN <- lapply(1:nsim, function(x)
+        popdynOneTScpp(nareas, maxage, SSBcurr=colSums(SSB_P[x,, ]), Ncurr=N_P[x,,],
+                       Zcurr=Z_P[x,,], PerrYr=Perr_y[x, y+nyears+maxage-1], hs=hs[x],
+                       R0a=R0a[x,], SSBpR=SSBpR[x,], aR=aR[x,], bR=bR[x,],
+                       mov=mov[x,,,,movYr(mov, nyears+y)], SRrel=SRrel[x],
+                       plusgroup=plusgroup))
       
-      # ---- Bio-economics ----
-      RetainCatch <- apply(CB_Pret[,,y,], 1, sum) # retained catch this year
-      RetainCatch[RetainCatch<=0] <- tiny
-      Cost_out[,mm,y] <-  Effort[, mm, y] * CostCurr*(1+CostInc/100)^y # cost of effort this year
-      Rev_out[,mm,y] <- (RevPC*(1+RevInc/100)^y * RetainCatch)
-      PMargin <- 1 - Cost_out[,mm,y]/Rev_out[,mm,y] # profit margin this year
-      Profit <- Rev_out[,mm,y] - Cost_out[,mm,y] # profit this year
-      Effort_pot <- Effort_pot + Response*Profit # bio-economic effort next year
-      Effort_pot[Effort_pot<0] <- tiny # 
-      LatEffort_out[,mm,y] <- LastTAE - Effort[, mm, y]  # store the Latent Effort
-      TAE_out[,mm,y] <- LastTAE # store the TAE
+      N_P <- aperm(array(unlist(NextYrN), dim=c(maxage, nareas, nsim)), c(3,1,2)) 
+      Biomass_P <- N_P * Wt_age[,,nyears+y]  # Calculate biomass
+      VBiomass_P <- Biomass_P * V_P[,,nyears+y]  # Calculate vulnerable biomass
+      SSN_P <- N_P * Mat_age[,,nyears+y]  # Calculate spawning stock numbers
+      SSB_P <- SSN_P * Wt_age[,,nyears+y]  # Calculate spawning stock biomass
       
-      # --- Begin projection years ----
-      for (y in 2:proyears) {
-        if(!silent) {
-          cat("."); flush.console()
-        }
+      # --- An update year ----
+      if (y %in% upyrs) {
+        # --- Update Data object ---- 
+        MSEData <- updateData(Data=MSEData, OM, MPCalcs, Effort, Biomass, 
+                              ProjStore, SSB, SSB_P, VBiomass, VBiomass_P, 
+                              RefPoints, ErrList, FMSY_y, retA_P, retL_P, StockPars, 
+                              FleetPars, ObsPars, upyrs, interval[mm], y, 
+                              Misc=Data_p@Misc, SampCpars, DataStore)
+        dropProjYears(ProjStore, y)
         
-        SelectChanged <- FALSE
-        if (AnnualMSY) {
-          if (any(range(retA_P[,,nyears+y] - retA[,,nyears+y]) !=0)) SelectChanged <- TRUE
-          if (any(range(V_P[,,nyears+y] - V[,,nyears+y]) !=0))  SelectChanged <- TRUE
-        }
+        # Update Abundance and FMSY for FMSYref MPs
+        M_array <- array(0.5*M_ageArray[,,nyears+y], dim=c(nsim, maxage, nareas))
+        Atemp <- apply(VBiomass_P * exp(-M_array), 1, sum) # Abundance (mid-year before fishing)
+        MSEData@OM$A <- Atemp
+        MSEData@OM$FMSY <- FMSY_y[, y+OM@nyears]
         
-        # -- Calculate MSY stats for this year ----
-        if (AnnualMSY & SelectChanged) { #
-          y1 <- nyears + y
-          MSYrefsYr <- sapply(1:nsim, optMSY_eq, M_ageArray, Wt_age, Mat_age, 
-                              V_P, maxage, R0, SRrel, hs, yr.ind=y1)
-          MSY_y[,mm,y] <- MSYrefsYr[1, ]
-          FMSY_y[,mm,y] <- MSYrefsYr[2,]
-          SSBMSY_y[,mm,y] <- MSYrefsYr[3,]
-        }
+        # --- apply MP ----
+        runMP <- applyMP(Data=MSEData, MPs = MPs[mm], reps = reps, silent=TRUE)  # Apply MP
+        MPRecs <- runMP[[1]][[1]] # MP recommendations
+        Data_p <- runMP[[2]] # Data object object with saved info from MP 
+        Data_p@TAC <- MPRecs$TAC
+        # calculate pstar quantile of TAC recommendation dist 
         
-        TACa[, mm, y] <- TACa[, mm, y-1] # TAC same as last year unless changed 
-        SAYRt <- as.matrix(expand.grid(1:nsim, 1:maxage, y + nyears, 1:nareas))  # Trajectory year
-        SAYt <- SAYRt[, 1:3]
-        SAYtMP <- cbind(SAYt, mm)
-        SYt <- SAYRt[, c(1, 3)]
-        SAY1R <- as.matrix(expand.grid(1:nsim, 1:maxage, y - 1, 1:nareas))
-        SAYR <- as.matrix(expand.grid(1:nsim, 1:maxage, y, 1:nareas))
-        SY <- SAYR[, c(1, 3)]
-        SA <- SAYR[, 1:2]
-        S1 <- SAYR[, 1]
-        SAY <- SAYR[, 1:3]
-        S <- SAYR[, 1]
-        SR <- SAYR[, c(1, 4)]
-        SA2YR <- as.matrix(expand.grid(1:nsim, 2:maxage, y, 1:nareas))
-        SA1YR <- as.matrix(expand.grid(1:nsim, 1:(maxage - 1), y -1, 1:nareas))
+        TACused <- apply(Data_p@TAC, 2, quantile, p = pstar, na.rm = T) 
+        if (length(MPRecs$TAC) >0) {
+          # a TAC has been recommended
+          checkNA[y] <- sum(is.na(TACused))
+          TACused[is.na(TACused)] <- LastTAC[is.na(TACused)] # set to last yr TAC if NA
+          TACa[, y] <- TACused # recommended TAC 
+        }
         
-        # --- Age & Growth ----
-        NextYrN <- lapply(1:nsim, function(x)
-          popdynOneTScpp(nareas, maxage, SSBcurr=colSums(SSB_P[x,,y-1, ]), Ncurr=N_P[x,,y-1,],
-                         Zcurr=Z_P[x,,y-1,], PerrYr=Perr_y[x, y+nyears+maxage-1], hs=hs[x],
-                         R0a=R0a[x,], SSBpR=SSBpR[x,], aR=aR[x,], bR=bR[x,],
-                         mov=mov[x,,,, nyears+y], SRrel=SRrel[x],
-                         plusgroup=plusgroup))
         
-        N_P[,,y,] <- aperm(array(unlist(NextYrN), dim=c(maxage, nareas, nsim, 1)), c(3,1,4,2)) 
-        Biomass_P[SAYR] <- N_P[SAYR] * Wt_age[SAYt]  # Calculate biomass
-        VBiomass_P[SAYR] <- Biomass_P[SAYR] * V_P[SAYt]  # Calculate vulnerable biomass
-        SSN_P[SAYR] <- N_P[SAYR] * Mat_age[SAYt]  # Calculate spawning stock numbers
-        SSB_P[SAYR] <- SSN_P[SAYR] * Wt_age[SAYt]  # Calculate spawning stock biomass
+        # -- Calc stock dynamics ----
+        MPCalcs <- CalcMPDynamics(MPRecs, y, nyears, proyears, nsim, Biomass_P, VBiomass_P,
+                                  LastTAE, histTAE, LastSpatial, LastAllocat, LastTAC,
+                                  TACused, maxF,
+                                  LR5_P, LFR_P, Rmaxlen_P, retL_P, retA_P,
+                                  L5_P, LFS_P, Vmaxlen_P, SLarray_P, V_P,
+                                  Fdisc_P, DR_P,
+                                  M_ageArray, FM_P, FM_Pret, Z_P, CB_P, CB_Pret,
+                                  TAC_f, E_f, SizeLim_f,
+                                  FinF, Spat_targ,
+                                  CAL_binsmid, Linf, Len_age, maxage, nareas, Asize, nCALbins,
+                                  qs, qvar, qinc, Effort_pot)
+      
+        LastSpatial <- MPCalcs$Si
+        LastAllocat <- MPCalcs$Ai
+        LastTAE <- MPCalcs$TAE # adjustment to TAE
+        Effort[, y] <- MPCalcs$Effort 
+        FMa[, y] <- MPCalcs$Ftot 
         
-        # --- An update year ----
-        if (y %in% upyrs) {
-          # --- Update Data object ---- 
-          MSElist[[mm]] <- updateData(Data=MSElist[[mm]], OM, MPCalcs, Effort, Biomass, 
-                                      Biomass_P, CB_Pret, N_P, SSB, SSB_P, VBiomass, VBiomass_P, 
-                                      RefPoints, ErrList, FMSY_y, retA_P, retL_P, StockPars, 
-                                      FleetPars, ObsPars, upyrs, interval, y, mm, 
-                                      Misc=Data_p@Misc, SampCpars)
-          
-          
-          # Update Abundance and FMSY for FMSYref MPs
-          M_array <- array(0.5*M_ageArray[,,nyears+y], dim=c(nsim, maxage, nareas))
-          Atemp <- apply(VBiomass_P[, , y, ] * exp(-M_array), 1, sum) # Abundance (mid-year before fishing)
-          MSElist[[mm]]@OM$A <- Atemp
-          MSElist[[mm]]@OM$FMSY <- FMSY_y[,mm,y+OM@nyears]
-          
-          # --- apply MP ----
-          runMP <- applyMP(Data=MSElist[[mm]], MPs = MPs[mm], reps = reps, silent=TRUE)  # Apply MP
-          MPRecs <- runMP[[1]][[1]] # MP recommendations
-          Data_p <- runMP[[2]] # Data object object with saved info from MP 
-          Data_p@TAC <- MPRecs$TAC
-          # calculate pstar quantile of TAC recommendation dist 
-          
-          TACused <- apply(Data_p@TAC, 2, quantile, p = pstar, na.rm = T) 
-          if (length(MPRecs$TAC) >0) {
-            # a TAC has been recommended
-            checkNA[y] <- sum(is.na(TACused))
-            TACused[is.na(TACused)] <- LastTAC[is.na(TACused)] # set to last yr TAC if NA
-            TACa[, mm, y] <- TACused # recommended TAC 
-          }
-          
-          
-          # -- Calc stock dynamics ----
-          MPCalcs <- CalcMPDynamics(MPRecs, y, nyears, proyears, nsim, Biomass_P, VBiomass_P,
-                                    LastTAE, histTAE, LastSpatial, LastAllocat, LastTAC,
-                                    TACused, maxF,
-                                    LR5_P, LFR_P, Rmaxlen_P, retL_P, retA_P,
-                                    L5_P, LFS_P, Vmaxlen_P, SLarray_P, V_P,
-                                    Fdisc_P, DR_P,
-                                    M_ageArray, FM_P, FM_Pret, Z_P, CB_P, CB_Pret,
-                                    TAC_f, E_f, SizeLim_f,
-                                    FinF, Spat_targ,
-                                    CAL_binsmid, Linf, Len_age, maxage, nareas, Asize, nCALbins,
-                                    qs, qvar, qinc, Effort_pot)
+        CB_P <- MPCalcs$CB_P # removals
+        CB_Pret <- MPCalcs$CB_Pret # retained catch 
+        LastTAC <- TACa[, y] # apply(CB_Pret[,,y,], 1, sum, na.rm=TRUE) 
+        FM_P <- MPCalcs$FM_P # fishing mortality
+        FM_Pret <- MPCalcs$FM_Pret # retained fishing mortality 
+        Z_P <- MPCalcs$Z_P # total mortality
+        retA_P <- MPCalcs$retA_P # retained-at-age
+        retL_P <- MPCalcs$retL_P # retained-at-length
+        V_P <- MPCalcs$V_P  # vulnerable-at-age
+        SLarray_P <- MPCalcs$SLarray_P # vulnerable-at-length
         
-          LastSpatial <- MPCalcs$Si
-          LastAllocat <- MPCalcs$Ai
-          LastTAE <- MPCalcs$TAE # adjustment to TAE
-          Effort[, mm, y] <- MPCalcs$Effort 
-          FMa[,mm,y] <- MPCalcs$Ftot 
-          
-          CB_P <- MPCalcs$CB_P # removals
-          CB_Pret <- MPCalcs$CB_Pret # retained catch 
-          LastTAC <- TACa[, mm, y] # apply(CB_Pret[,,y,], 1, sum, na.rm=TRUE) 
-          FM_P <- MPCalcs$FM_P # fishing mortality
-          FM_Pret <- MPCalcs$FM_Pret # retained fishing mortality 
-          Z_P <- MPCalcs$Z_P # total mortality
-          retA_P <- MPCalcs$retA_P # retained-at-age
-          retL_P <- MPCalcs$retL_P # retained-at-length
-          V_P <- MPCalcs$V_P  # vulnerable-at-age
-          SLarray_P <- MPCalcs$SLarray_P # vulnerable-at-length
-          
-          # ---- Bio-economics ----
-          RetainCatch <- apply(CB_Pret[,,y,], 1, sum) # retained catch this year
-          RetainCatch[RetainCatch<=0] <- tiny
-          Cost_out[,mm,y] <-  Effort[, mm, y] * CostCurr*(1+CostInc/100)^y # cost of effort this year
-          Rev_out[,mm,y] <- (RevPC*(1+RevInc/100)^y * RetainCatch)
-          Profit <- Rev_out[,mm,y] - Cost_out[,mm,y] # profit this year
-          Effort_pot <- Effort_pot + Response*Profit # bio-economic effort next year
-          Effort_pot[Effort_pot<0] <- tiny # 
-          LatEffort_out[,mm,y] <- LastTAE - Effort[, mm, y]  # store the Latent Effort
-          TAE_out[,mm,y] <- LastTAE # store the TAE
+        # ---- Bio-economics ----
+        RetainCatch <- apply(CB_Pret, 1, sum) # retained catch this year
+        RetainCatch[RetainCatch<=0] <- tiny
+        Cost_out[, y] <-  Effort[, y] * CostCurr*(1+CostInc/100)^y # cost of effort this year
+        Rev_out[, y] <- (RevPC*(1+RevInc/100)^y * RetainCatch)
+        Profit <- Rev_out[, y] - Cost_out[, y] # profit this year
+        Effort_pot <- Effort_pot + Response*Profit # bio-economic effort next year
+        Effort_pot[Effort_pot<0] <- tiny # 
+        LatEffort_out[, y] <- LastTAE - Effort[, y]  # store the Latent Effort
+        TAE_out[, y] <- LastTAE # store the TAE
 
-        } else {
-          # --- Not an update yr ----
-          NoMPRecs <- MPRecs # TAC & TAE stay the same
-          NoMPRecs[lapply(NoMPRecs, length) > 0 ] <- NULL
-          NoMPRecs$Spatial <- NA
-          MPCalcs <- CalcMPDynamics(NoMPRecs, y, nyears, proyears, nsim, Biomass_P, VBiomass_P,
-                                    LastTAE, histTAE, LastSpatial, LastAllocat, LastTAC,
-                                    TACused, maxF,
-                                    LR5_P, LFR_P, Rmaxlen_P, retL_P, retA_P,
-                                    L5_P, LFS_P, Vmaxlen_P, SLarray_P, V_P,
-                                    Fdisc_P, DR_P,
-                                    M_ageArray, FM_P, FM_Pret, Z_P, CB_P, CB_Pret,
-                                    TAC_f, E_f, SizeLim_f,
-                                    FinF, Spat_targ,
-                                    CAL_binsmid, Linf, Len_age, maxage, nareas,
-                                    Asize, nCALbins,
-                                    qs, qvar, qinc, Effort_pot)
-          
-          
-          TACa[, mm, y] <- TACused # 
-          LastSpatial <- MPCalcs$Si
-          LastAllocat <- MPCalcs$Ai
-          LastTAE <- MPCalcs$TAE
-          Effort[, mm, y] <- MPCalcs$Effort  
-          CB_P <- MPCalcs$CB_P # removals
-          CB_Pret <- MPCalcs$CB_Pret # retained catch 
-          FMa[,mm,y] <- MPCalcs$Ftot 
-          LastTAC <- TACa[, mm, y]  # apply(CB_Pret[,,y,], 1, sum, na.rm=TRUE) 
-          FM_P <- MPCalcs$FM_P # fishing mortality
-          FM_Pret <- MPCalcs$FM_Pret # retained fishing mortality 
-          Z_P <- MPCalcs$Z_P # total mortality
-          retA_P <- MPCalcs$retA_P # retained-at-age
-          retL_P <- MPCalcs$retL_P # retained-at-length
-          V_P <- MPCalcs$V_P  # vulnerable-at-age
-          SLarray_P <- MPCalcs$SLarray_P # vulnerable-at-length
-          
-          # ---- Bio-economics ----
-          RetainCatch <- apply(CB_Pret[,,y,], 1, sum) # retained catch this year
-          RetainCatch[RetainCatch<=0] <- tiny
-          Cost_out[,mm,y] <-  Effort[, mm, y] * CostCurr*(1+CostInc/100)^y # cost of effort this year
-          Rev_out[,mm,y] <- (RevPC*(1+RevInc/100)^y * RetainCatch)
-          PMargin <- 1 - Cost_out[,mm,y]/Rev_out[,mm,y] # profit margin this year
-          Profit <- Rev_out[,mm,y] - Cost_out[,mm,y] # profit this year
-          Effort_pot <- Effort_pot + Response*Profit # bio-economic effort next year
-          Effort_pot[Effort_pot<0] <- tiny # 
-          LatEffort_out[,mm,y] <- LastTAE - Effort[, mm, y]  # store the Latent Effort
-          TAE_out[,mm,y] <- LastTAE # store the TAE
+      } else {
+        # --- Not an update yr ----
+        NoMPRecs <- MPRecs # TAC & TAE stay the same
+        NoMPRecs[lapply(NoMPRecs, length) > 0 ] <- NULL
+        NoMPRecs$Spatial <- NA
+        MPCalcs <- CalcMPDynamics(NoMPRecs, y, nyears, proyears, nsim, Biomass_P, VBiomass_P,
+                                  LastTAE, histTAE, LastSpatial, LastAllocat, LastTAC,
+                                  TACused, maxF,
+                                  LR5_P, LFR_P, Rmaxlen_P, retL_P, retA_P,
+                                  L5_P, LFS_P, Vmaxlen_P, SLarray_P, V_P,
+                                  Fdisc_P, DR_P,
+                                  M_ageArray, FM_P, FM_Pret, Z_P, CB_P, CB_Pret,
+                                  TAC_f, E_f, SizeLim_f,
+                                  FinF, Spat_targ,
+                                  CAL_binsmid, Linf, Len_age, maxage, nareas,
+                                  Asize, nCALbins,
+                                  qs, qvar, qinc, Effort_pot)
         
-        } # end of update loop 
-       
-      }  # end of year loop
-      
-      B_BMSYa[, mm, ] <- apply(SSB_P, c(1, 3), sum, na.rm=TRUE)/SSBMSY_y[,mm,(OM@nyears+1):(OM@nyears+OM@proyears)]  # SSB relative to SSBMSY
-      F_FMSYa[, mm, ] <- FMa[, mm, ]/FMSY_y[,mm,(OM@nyears+1):(OM@nyears+OM@proyears)]
-      
-      Ba[, mm, ] <- apply(Biomass_P, c(1, 3), sum, na.rm=TRUE) # biomass 
-      SSBa[, mm, ] <- apply(SSB_P, c(1, 3), sum, na.rm=TRUE) # spawning stock biomass
-      VBa[, mm, ] <- apply(VBiomass_P, c(1, 3), sum, na.rm=TRUE) # vulnerable biomass
-      
-      Ca[, mm, ] <- apply(CB_P, c(1, 3), sum, na.rm=TRUE) # removed
-      CaRet[, mm, ] <- apply(CB_Pret, c(1, 3), sum, na.rm=TRUE) # retained catch 
-      
-      # Store Pop and Catch-at-age and at-length for last projection year 
-      PAAout[ , mm, ] <- apply(N_P[ , , proyears, ], c(1,2), sum) # population-at-age
-      
-      CNtemp <- apply(CB_Pret, c(1,2,3), sum)/Wt_age[,,(nyears+1):(nyears+proyears)]
-      CAAout[ , mm, ] <- CNtemp[,,proyears] # nsim, maxage # catch-at-age
-      CALdat <- MSElist[[mm]]@CAL
-      CALout[ , mm, ] <- CALdat[,dim(CALdat)[2],] # catch-at-length in last year
+        
+        TACa[, y] <- TACused # 
+        LastSpatial <- MPCalcs$Si
+        LastAllocat <- MPCalcs$Ai
+        LastTAE <- MPCalcs$TAE
+        Effort[, y] <- MPCalcs$Effort  
+        CB_P <- MPCalcs$CB_P # removals
+        CB_Pret <- MPCalcs$CB_Pret # retained catch 
+        FMa[, y] <- MPCalcs$Ftot 
+        LastTAC <- TACa[, y]  # apply(CB_Pret[,,y,], 1, sum, na.rm=TRUE) 
+        FM_P <- MPCalcs$FM_P # fishing mortality
+        FM_Pret <- MPCalcs$FM_Pret # retained fishing mortality 
+        Z_P <- MPCalcs$Z_P # total mortality
+        retA_P <- MPCalcs$retA_P # retained-at-age
+        retL_P <- MPCalcs$retL_P # retained-at-length
+        V_P <- MPCalcs$V_P  # vulnerable-at-age
+        SLarray_P <- MPCalcs$SLarray_P # vulnerable-at-length
+        
+        # ---- Bio-economics ----
+        RetainCatch <- apply(CB_Pret, 1, sum) # retained catch this year
+        RetainCatch[RetainCatch<=0] <- tiny
+        Cost_out[, y] <-  Effort[, y] * CostCurr*(1+CostInc/100)^y # cost of effort this year
+        Rev_out[, y] <- (RevPC*(1+RevInc/100)^y * RetainCatch)
+        PMargin <- 1 - Cost_out[, y]/Rev_out[, y] # profit margin this year
+        Profit <- Rev_out[, y] - Cost_out[, y] # profit this year
+        Effort_pot <- Effort_pot + Response*Profit # bio-economic effort next year
+        Effort_pot[Effort_pot<0] <- tiny # 
+        LatEffort_out[, y] <- LastTAE - Effort[, y]  # store the Latent Effort
+        TAE_out[, y] <- LastTAE # store the TAE
       
-      if (!silent) {
-        cat("\n")
-        if (all(checkNA[upyrs] != nsim) & !all(checkNA == 0)) {
-          ntot <- sum(checkNA[upyrs])
-          totyrs <- sum(checkNA[upyrs] >0)
-          nfrac <- round(ntot/(length(upyrs)*nsim),2)*100
-          message(totyrs, ' years had TAC = NA for some simulations (', nfrac, "% of total simulations)")
-          message('Used TAC_y = TAC_y-1')  
-        }
+      } # end of update loop 
+      setProjYear(ProjStore, y, N=N_P, Biomass=Biomass_P, VBiomass=VBiomass_P, 
+                  SSN=SSN_P, SSB=SSB_P, FM=FM_P, FMret=FM_Pret, Z=Z_P, 
+                  CB=CB_P, CBret=CB_Pret)
+     
+    }  # end of year loop
+    
+    B_BMSYa[, ] <- sumProj(ProjStore, "SSB", na.rm=TRUE)/SSBMSY_y[, (OM@nyears+1):(OM@nyears+OM@proyears)]  # SSB relative to SSBMSY
+    F_FMSYa[, ] <- FMa[, ]/FMSY_y[, (OM@nyears+1):(OM@nyears+OM@proyears)]
+    
+    Ba[, ] <- sumProj(ProjStore, "Biomass", na.rm=TRUE) # biomass 
+    SSBa[, ] <- sumProj(ProjStore, "SSB", na.rm=TRUE) # spawning stock biomass
+    VBa[, ] <- sumProj(ProjStore, "VBiomass", na.rm=TRUE) # vulnerable biomass
+    
+    CaRet[, ] <- sumProj(ProjStore, "CBret", na.rm=TRUE) # retained catch 
+    
+    # Store Pop and Catch-at-age and at-length for last projection year 
+    # (the *_P arrays are the last projection year)
+    PAAout[, ] <- apply(N_P, c(1,2), sum) # population-at-age
+    
+    CAAout[, ] <- apply(CB_Pret, c(1,2), sum)/Wt_age[,,nyears+proyears] # nsim, maxage # catch-at-age
+    CALdat <- MSEData@CAL
+    CALout[, ] <- CALdat[,dim(CALdat)[2],] # catch-at-length in last year
+    
+    if (!silent) {
+      cat("\n")
+      if (all(checkNA[upyrs] != nsim) & !all(checkNA == 0)) {
+        ntot <- sum(checkNA[upyrs])
+        totyrs <- sum(checkNA[upyrs] >0)
+        nfrac <- round(ntot/(length(upyrs)*nsim),2)*100
+        message(totyrs, ' years had TAC = NA for some simulations (', nfrac, "% of total simulations)")
+        message('Used TAC_y = TAC_y-1')  
       }
-      
-      if (!parallel) 
-        if("progress"%in%names(control))
-          if(control$progress) 
-            shiny::incProgress(1/nMP, detail = round(mm*100/nMP))
-
-    }, silent=TRUE)
-    # end try
-    # , error=function(e) {
-      # message("Note: ", MPs[mm], " failed. Skipping this MP.")
-      # message(e, "\n")
-    # }) # end tryCatch ####
-    if (!is.null(tryMP)) {
-      if(!silent) message("Note: ", MPs[mm], " failed. Skipping this MP. \nSee `MSE@Misc$TryMP` for details")
-      Misc$TryMP[[mm]] <- tryMP
-    } else {
-      Misc$TryMP[[mm]] <- "Okay"
     }
 
-    
-    
-  }  # end of mm methods 
-  
-  # Miscellaneous reporting
-  if(PPD) Misc$Data <- MSElist
+    NULL
+  }, silent=TRUE)
+  # end try
+  
+  list(B_BMSY=B_BMSYa, F_FMSY=F_FMSYa, B=Ba, SSB=SSBa, VB=VBa, FM=FMa, 
+       CRet=CaRet, TAC=TACa, Effort=Effort, PAA=PAAout, CAA=CAAout, CAL=CALout,
+       Cost=Cost_out, Rev=Rev_out, LatEffort=LatEffort_out, TAE=TAE_out, 
+       Data=if (PPD) MSEData, TryMP=tryMP)
+}
 
-  # Report profit margin and latent effort
-  Misc$LatEffort <- LatEffort_out
-  Misc$Revenue <- Rev_out
-  Misc$Cost <- Cost_out
-  Misc$TAE <- TAE_out
-  
-  ## Create MSE Object #### 
-  MSEout <- new("MSE", Name = OM@Name, nyears, proyears, nMPs=nMP, MPs, nsim, 
-                Data@OM, Obs=Data@Obs, B_BMSY=B_BMSYa, F_FMSY=F_FMSYa, B=Ba, 
-                SSB=SSBa, VB=VBa, FM=FMa, CaRet, TAC=TACa, SSB_hist = SSB, 
-                CB_hist = CB, FM_hist = FM, Effort = Effort, PAA=PAAout, 
-                CAA=CAAout, CAL=CALout, CALbins=CAL_binsmid, Misc = Misc)
-  # Store MSE info
-  attr(MSEout, "version") <- packageVersion("DLMtool")
-  attr(MSEout, "date") <- date()
-  attr(MSEout, "R.version") <- R.version
-  
-  MSEout 
+# Units of 2 (or 3) consecutive simulations that are projected with their own 
+# random number seed in parallel mode. They only depend on nsim.
+SeedUnits <- function(nsim) {
+  split(1:nsim, sort(rep_len(1:max(1, floor(nsim/2)), nsim)))
+}
+
+# Divide the simulations into blocks of whole SeedUnits, aiming for about 4 
+# tasks (block x MP) per core. The blocks only change how the work is shared 
+# among the cores, not the results.
+SimBlocks <- function(nsim, nMP, ncpu, blocksize=NULL) {
+  units <- SeedUnits(nsim)
+  if (is.null(blocksize)) blocksize <- nsim * nMP / (4 * ncpu)
+  nblocks <- max(1, min(length(units), floor(nsim/blocksize)))
+  lapply(split(units, sort(rep_len(1:nblocks, length(units)))), unlist, use.names=FALSE)
+}
+
+# Join the projectMP results of consecutive units of simulations
+joinMPout <- function(MPout) {
+  if (length(MPout) == 1) return(MPout[[1]])
+  out <- MPout[[1]]
+  for (nm in setdiff(names(out), c("Data", "TryMP"))) {
+    if (!is.null(out[[nm]])) out[[nm]] <- joinSims(lapply(MPout, "[[", nm))
+  }
+  tryMP <- lapply(MPout, "[[", "TryMP")
+  failed <- vapply(tryMP, inherits, logical(1), what="try-error")
+  if (any(failed)) {
+    out["TryMP"] <- list(tryMP[[which(failed)[1]]])
+  } else if (!is.null(out$Data)) {
+    out$Data <- joinData(lapply(MPout, "[[", "Data"))
+  }
+  out
 }
 
 
@@ -0,0 +1,203 @@
+#include <Rcpp.h>
+#include "brent.h"
+#include "movArray.h"
+using namespace Rcpp;
+
+// Projection of one simulation for the Blow calculation (see Blow_opt). The
+// population is projected from the first historical year with the historical
+// effort, and then for MGThorizon years with no fishing. The life-history,
+// selectivity and spatial closures of the last historical year are used for the
+// projection years and the movement of the last historical year is used in all
+// years. These are read from the arrays of all simulations rather than copied.
+struct BlowSim {
+  int s, nsim, maxage, nareas, nyears, nyrs, pyears, SRrel, plusgroup, nMPA;
+  const double *N, *Asize, *SSBpR, *MPA, *Find, *Perr, *M, *Mat, *Wt, *V, *R0a, *aR, *bR;
+  const MovArray* mov;
+  double h, Spat, maxF, SSBMSY, Bfrac;
+
+  // element of an nsim x maxage x nyrs array
+  inline double age_yr(const double* x, int a, int y) const {
+    if (y > nyears - 1) y = nyears - 1;
+    return x[s + (size_t) nsim * (a + (size_t) maxage * y)];
+  }
+
+  // SSB in the last historical year and the last projection year for catchability q
+  void project(double q, double& SSBnow, double& SSBend) const {
+    std::vector<double> Ncur(maxage * nareas), Nnext(maxage * nareas), Z(maxage * nareas);
+    std::vector<double> SB(nareas), VB(nareas), fishdist(nareas);
+    for (int A = 0; A < nareas; A++)
+      for (int a = 0; a < maxage; a++)
+        Ncur[a + maxage * A] = N[s + (size_t) nsim * (a + (size_t) maxage * (size_t) nyears * A)];
+
+    for (int y = 0; y < pyears; y++) {
+      double SSB = 0;
+      for (int A = 0; A < nareas; A++) {
+        SB[A] = 0;
+        VB[A] = 0;
+        for (int a = 0; a < maxage; a++) {
+          double NW = Ncur[a + maxage * A] * age_yr(Wt, a, y);
+          SB[A] += NW * age_yr(Mat, a, y);
+          VB[A] += NW * age_yr(V, a, y);
+        }
+        SSB += SB[A];
+      }
+      if (y == nyears - 1) SSBnow = SSB;
+      if (y == pyears - 1) {
+        SSBend = SSB;
+        break;
+      }
+
+      // fishing mortality - distributed by vulnerable biomass and open areas
+      double tot = 0;
+      for (int A = 0; A < nareas; A++) {
+        fishdist[A] = std::pow(VB[A], Spat);
+        tot += fishdist[A];
+      }
+      for (int A = 0; A < nareas; A++) fishdist[A] /= tot;
+      if (y > 0) {
+        int yy = std::min(y - 1, nyears - 1);
+        double fracE = 0;
+        for (int A = 0; A < nareas; A++) {
+          fishdist[A] *= MPA[yy + (size_t) nMPA * A];
+          fracE += fishdist[A];
+        }
+        for (int A = 0; A < nareas; A++) fishdist[A] = fishdist[A] * (fracE + (1 - fracE))/fracE;
+      }
+      double E = (y < nyears) ? Find[s + (size_t) nsim * y] : 0;
+      for (int A = 0; A < nareas; A++) {
+        for (int a = 0; a < maxage; a++) {
+          double FM = (E * q * fishdist[A] * age_yr(V, a, y))/Asize[s + nsim * A];
+          if (FM > maxF) FM = maxF;
+          Z[a + maxage * A] = age_yr(M, a, y) + FM;
+        }
+      }
+
+      // recruitment and mortality (as popdynOneTScpp)
+      double Prec = (y < nyears) ? Perr[s + (size_t) nsim * (y + maxage)] : 1;
+      for (int A = 0; A < nareas; A++) {
+        double R0 = R0a[s + nsim * A];
+        if (SRrel == 1) {
+          Nnext[maxage * A] = Prec * (4 * R0 * h * SB[A])/(SSBpR[s + nsim * A] * R0 * (1 - h) + (5 * h - 1) * SB[A]);
+        } else {
+          Nnext[maxage * A] = Prec * aR[s + nsim * A] * SB[A] * std::exp(-bR[s + nsim * A] * SB[A]);
+        }
+        for (int a = 1; a < maxage; a++)
+          Nnext[a + maxage * A] = Ncur[a - 1 + maxage * A] * std::exp(-Z[a - 1 + maxage * A]);
+        if (plusgroup > 0)
+          Nnext[maxage - 1 + maxage * A] /= (1 - std::exp(-Z[maxage - 1 + maxage * A]));
+      }
+
+      // movement
+      for (int a = 0; a < maxage; a++) {
+        for (int B = 0; B < nareas; B++) {
+          double val = 0;
+          for (int A = 0; A < nareas; A++) {
+            val += Nnext[a + maxage * A] * (*mov)(s, a, A, B, nyears - 1);
+          }
+          Ncur[a + maxage * B] = val;
+        }
+      }
+    }
+  }
+
+  // objective of Blow_opt (mode 1)
+  double operator()(double lnq) {
+    double SSBnow = 0, SSBend = 0;
+    project(std::exp(lnq), SSBnow, SSBend);
+    double pen = 0;
+    if (SSBnow > 0.8 * SSBMSY) pen = (SSBnow - 0.8 * SSBMSY) * (SSBnow - 0.8 * SSBMSY);
+    double dev = std::log(SSBend) - std::log(SSBMSY * Bfrac);
+    return pen + dev * dev;
+  }
+};
+
+//' Calculate Blow for all simulations
+//'
+//' Finds the spawning biomass in the last historical year from which it would
+//' take `MGThorizon` years to reach `Bfrac` x SSBMSY with no fishing. The
+//' catchability of the historical period is searched with the same algorithm as
+//' `optimize` in `getBlow`. The projection years use the values of the last
+//' historical year directly rather than extended copies of the arrays.
+//'
+//' @param N Array of numbers-at-age with dimensions `c(nsim, maxage, nyears, nareas)`
+//' @param Asize Matrix of area size (nsim by nareas)
+//' @param SSBMSY Vector (nsim long) of spawning biomass at MSY
+//' @param SSBpR Matrix (nsim by nareas) of SSB per recruit
+//' @param MPA Matrix (nyears + proyears by nareas) of spatial closures
+//' @param MGThorizon Vector (nsim long) of the number of years to rebuild
+//' @param Find Matrix (nsim by nyears) of historical effort
+//' @param Perr Matrix of recruitment deviations (nsim by nyears + proyears + maxage - 1)
+//' @param M_ageArray Array of natural mortality (nsim, maxage, nyears + proyears)
+//' @param hs Vector (nsim long) of steepness
+//' @param Mat_age Array of maturity-at-age (nsim, maxage, nyears + proyears)
+//' @param Wt_age Array of weight-at-age (nsim, maxage, nyears + proyears)
+//' @param R0a Matrix (nsim by nareas) of unfished recruitment
+//' @param V Array of vulnerability-at-age (nsim, maxage, nyears + proyears)
+//' @param mov Array of movement (nsim, maxage, nareas, nareas, nyears + proyears). See `compactMov`.
+//' @param Spat_targ Vector (nsim long) of spatial targeting parameters
+//' @param SRrel Integer vector (nsim long) of stock-recruit relationships (1: Beverton-Holt, 2: Ricker)
+//' @param aR Matrix (nsim by nareas) of Ricker a parameters
+//' @param bR Matrix (nsim by nareas) of Ricker b parameters
+//' @param Bfrac Fraction of SSBMSY that is the target
+//' @param maxF Maximum fishing mortality for any age class
+//' @param plusgroup Integer. Include a plus-group (1) or not (0)?
+//'
+//' @return Vector (nsim long) of Blow
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector getBlowCPP(NumericVector N, NumericMatrix Asize, NumericVector SSBMSY, NumericMatrix SSBpR,
+                         NumericMatrix MPA, IntegerVector MGThorizon, NumericMatrix Find,
+                         NumericMatrix Perr, NumericVector M_ageArray, NumericVector hs,
+                         NumericVector Mat_age, NumericVector Wt_age, NumericMatrix R0a,
+                         NumericVector V, NumericVector mov, NumericVector Spat_targ,
+                         IntegerVector SRrel, NumericMatrix aR, NumericMatrix bR,
+                         double Bfrac, double maxF, int plusgroup) {
+  IntegerVector Ndim = N.attr("dim");
+  IntegerVector Mdim = M_ageArray.attr("dim");
+  BlowSim sim;
+  sim.nsim = Ndim[0];
+  sim.maxage = Ndim[1];
+  sim.nyears = Ndim[2];
+  sim.nareas = Ndim[3];
+  sim.nyrs = Mdim[2];
+  sim.nMPA = MPA.nrow();
+  sim.plusgroup = plusgroup;
+  sim.N = N.begin();
+  sim.Asize = Asize.begin();
+  sim.SSBpR = SSBpR.begin();
+  sim.MPA = MPA.begin();
+  sim.Find = Find.begin();
+  sim.Perr = Perr.begin();
+  sim.M = M_ageArray.begin();
+  sim.Mat = Mat_age.begin();
+  sim.Wt = Wt_age.begin();
+  sim.V = V.begin();
+  sim.R0a = R0a.begin();
+  sim.aR = aR.begin();
+  sim.bR = bR.begin();
+  MovArray movarr(mov);
+  sim.mov = &movarr;
+  sim.maxF = maxF;
+  sim.Bfrac = Bfrac;
+
+  NumericVector Blow(sim.nsim);
+  for (int s = 0; s < sim.nsim; s++) {
+    checkUserInterrupt();
+    if (MGThorizon[s] == NA_INTEGER) {
+      Blow[s] = NA_REAL;
+      continue;
+    }
+    sim.s = s;
+    sim.pyears = sim.nyears + MGThorizon[s];
+    sim.SRrel = SRrel[s];
+    sim.h = hs[s];
+    sim.Spat = Spat_targ[s];
+    sim.SSBMSY = SSBMSY[s];
+    double lnq = brent_fmin(std::log(0.0075), std::log(15.0), sim);
+    double SSBnow = NA_REAL, SSBend = NA_REAL;
+    sim.project(std::exp(lnq), SSBnow, SSBend);
+    Blow[s] = SSBnow;
+  }
+  return Blow;
+}
@@ -0,0 +1,269 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+// Fishing mortality, catch and effort of one projection year from the
+// management recommendations (see CalcMPDynamics). The recommendations are
+// checked and the selectivity and retention curves are updated in R. The
+// arrays of the current year have dimensions c(nsim, maxage, nareas). The sums
+// are accumulated in the same order and extended precision as sum().
+//
+// If a TAC is set, the effort is solved so that the retained catch of the
+// projection catch equation (the same as catchF) is exactly the TAC. The
+// fishing mortality of each age class and area is proportional to the effort,
+// so this is a one-dimensional root for each simulation.
+struct MPDynamics {
+  int nsim, maxage, nareas, y;
+  const double *B, *V, *retA, *M, *Si, *FinF, *qvar, *qs, *qinc, *Asize;
+  double maxF;
+  std::vector<double> fishdist, fracE2sum, CurrentVB;
+
+  inline size_t sa(int s, int a) const { return s + (size_t) nsim * a; }
+  inline size_t sar(int s, int a, int r) const { return s + (size_t) nsim * (a + (size_t) maxage * r); }
+
+  // fishing mortality of the total and retained catch with effort E
+  void effortF(const double* E, NumericVector& FM, NumericVector& FMret) const {
+    for (int r = 0; r < nareas; r++) {
+      for (int a = 0; a < maxage; a++) {
+        for (int s = 0; s < nsim; s++) {
+          size_t i = sar(s, a, r);
+          FM[i] = E[s] * Fper(s, a, r, V);
+          FMret[i] = E[s] * Fper(s, a, r, retA);
+        }
+      }
+    }
+  }
+
+  // apply the maxF constraint, and calculate total mortality and catch
+  void catchF(NumericVector& FM, NumericVector& FMret, NumericVector& Z,
+              NumericVector& CB, NumericVector& CBret) const {
+    for (int r = 0; r < nareas; r++) {
+      for (int a = 0; a < maxage; a++) {
+        for (int s = 0; s < nsim; s++) {
+          size_t i = sar(s, a, r);
+          double Ma = M[sa(s, a)];
+          if (FM[i] > maxF) FM[i] = maxF;
+          if (FMret[i] > maxF) FMret[i] = maxF;
+          Z[i] = FM[i] + Ma;
+          CB[i] = (1 - std::exp(-FM[i])) * (B[i] * std::exp(-0.5 * Ma));
+          CBret[i] = (1 - std::exp(-FMret[i])) * (B[i] * std::exp(-0.5 * Ma));
+        }
+      }
+    }
+  }
+
+  // fishing mortality of the total and retained catch per unit effort for one
+  // age class and area
+  inline double Fper(int s, int a, int r, const double* sel) const {
+    double S = Si[r + (size_t) nareas * s];
+    double fd = fishdist[s + (size_t) nsim * r];
+    double qy = R_pow(1 + qinc[s]/100, y);
+    return (FinF[s] * sel[sa(s, a)] * S * fd * qvar[s] * qs[s] * qy)/Asize[s + (size_t) nsim * r];
+  }
+
+  // effort for which the retained catch is TAC. The retained catch is an
+  // increasing concave function of effort, so Newton's method from zero
+  // effort converges from below without overshooting. If the TAC can't be
+  // caught, the effort at which every age class reaches maxF is returned.
+  double tacEffort(int s, double TAC, double tol = 1e-12, int maxit = 100) const {
+    if (!(TAC > 0)) return 0;
+    std::vector<double> F1(maxage * nareas), Bmid(maxage * nareas);
+    double Emax = 0;
+    long double Cmax = 0;
+    for (int r = 0; r < nareas; r++) {
+      for (int a = 0; a < maxage; a++) {
+        int k = a + maxage * r;
+        F1[k] = Fper(s, a, r, retA);
+        Bmid[k] = B[sar(s, a, r)] * std::exp(-0.5 * M[sa(s, a)]);
+        if (F1[k] > 0) {
+          Emax = std::max(Emax, maxF/F1[k]);
+          Cmax += (1 - std::exp(-maxF)) * Bmid[k];
+        }
+      }
+    }
+    if (!((double) Cmax > 0)) return 0;
+    if (TAC >= (double) Cmax) return Emax;
+
+    double E = 0;
+    for (int it = 0; it < maxit; it++) {
+      long double C = 0, dC = 0;
+      for (int k = 0; k < maxage * nareas; k++) {
+        if (!(F1[k] > 0)) continue;
+        double F = E * F1[k];
+        if (F >= maxF) {
+          C += (1 - std::exp(-maxF)) * Bmid[k];
+        } else {
+          double eF = std::exp(-F);
+          C += (1 - eF) * Bmid[k];
+          dC += F1[k] * eF * Bmid[k];
+        }
+      }
+      double f = TAC - (double) C;
+      if (f <= tol * TAC || !((double) dC > 0)) break;
+      double step = f/(double) dC;
+      E = std::min(E + step, Emax);
+      if (step <= tol * E) break;
+    }
+    return E;
+  }
+
+  // total fishing mortality from the removals and the vulnerable biomass
+  void totalF(const NumericVector& CB, const double* VBy, NumericVector& Ftot) const {
+    for (int s = 0; s < nsim; s++) {
+      long double C = 0, A = 0;
+      for (int r = 0; r < nareas; r++) {
+        for (int a = 0; a < maxage; a++) {
+          size_t i = sar(s, a, r);
+          C += CB[i];
+          A += VBy[i] * std::exp(-(0.5 * M[sa(s, a)]));
+        }
+      }
+      Ftot[s] = -std::log(1 - (double) C/(double) A);
+      if (!R_FINITE(Ftot[s])) Ftot[s] = maxF;
+    }
+  }
+};
+
+//' Fishing mortality, catch and effort from the MP recommendations
+//'
+//' The core of `CalcMPDynamics` for all simulations in one projection year.
+//' Effort is distributed among areas by the vulnerable biomass, the spatial
+//' closures and the reallocation of effort. If a TAC is set, the effort
+//' required to catch the TAC is solved with Newton's method, so that the retained
+//' catch of all age classes and areas is equal to the TAC. The effort is then
+//' limited by the potential effort and the TAE, and the fishing mortality and
+//' catch are calculated with the actual effort.
+//'
+//' @param Biomass_P Array of biomass in the current year `c(nsim, maxage, nareas)`
+//' @param VBiomass_P Array of vulnerable biomass in the current year `c(nsim, maxage, nareas)`
+//' @param V Matrix of vulnerability-at-age in the current year (nsim by maxage)
+//' @param retA Matrix of retention-at-age in the current year (nsim by maxage)
+//' @param M Matrix of natural mortality-at-age in the current year (nsim by maxage)
+//' @param Si Matrix of open (1) and closed (0) areas (nareas by nsim)
+//' @param Ai Vector (nsim long) of the reallocation of effort from closed areas
+//' @param TACusedE Vector (nsim long) of the TAC after implementation error, or
+//' an empty vector if there is no TAC
+//' @param Effort_pot Vector (nsim long) of potential effort from the bio-economic model
+//' @param TAE Vector (nsim long) of total allowable effort
+//' @param FinF Vector (nsim long) of fishing effort in the last historical year
+//' @param Spat_targ Vector (nsim long) of spatial targeting parameters
+//' @param qvar Vector (nsim long) of catchability variability in the current year
+//' @param qs Vector (nsim long) of catchability
+//' @param qinc Vector (nsim long) of the average annual percentage change in catchability
+//' @param y The projection year
+//' @param Asize Matrix of area size (nsim by nareas)
+//' @param maxF Maximum fishing mortality for any age class
+//'
+//' @return A named list with the arrays `FM_P`, `FM_Pret`, `Z_P`, `CB_P` and
+//' `CB_Pret` of the current year, and the vectors `Effort` (actual effort) and
+//' `Ftot` (total fishing mortality)
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+List CalcMPDynamicsCPP(NumericVector Biomass_P, NumericVector VBiomass_P, NumericVector V,
+                       NumericVector retA, NumericVector M, NumericVector Si, NumericVector Ai,
+                       NumericVector TACusedE, NumericVector Effort_pot, NumericVector TAE,
+                       NumericVector FinF, NumericVector Spat_targ, NumericVector qvar,
+                       NumericVector qs, NumericVector qinc, int y, NumericVector Asize,
+                       double maxF) {
+  const double tiny = 1e-15; // as tiny in R
+  IntegerVector dims = Biomass_P.attr("dim");
+  MPDynamics dyn;
+  int nsim = dyn.nsim = dims[0];
+  int maxage = dyn.maxage = dims[1];
+  int nareas = dyn.nareas = dims[2];
+  dyn.y = y;
+  dyn.B = Biomass_P.begin();
+  dyn.V = V.begin();
+  dyn.retA = retA.begin();
+  dyn.M = M.begin();
+  dyn.Si = Si.begin();
+  dyn.FinF = FinF.begin();
+  dyn.qvar = qvar.begin();
+  dyn.qs = qs.begin();
+  dyn.qinc = qinc.begin();
+  dyn.Asize = Asize.begin();
+  dyn.maxF = maxF;
+  size_t n = Biomass_P.size();
+
+  // vulnerable biomass with the current selectivity
+  dyn.CurrentVB.resize(n);
+  for (int r = 0; r < nareas; r++)
+    for (int a = 0; a < maxage; a++)
+      for (int s = 0; s < nsim; s++)
+        dyn.CurrentVB[dyn.sar(s, a, r)] = Biomass_P[dyn.sar(s, a, r)] * V[dyn.sa(s, a)];
+
+  // distribution of fishing effort if all areas were open, then accounting for
+  // spatial closures and reallocation of effort
+  dyn.fishdist.resize(nsim * nareas);
+  dyn.fracE2sum.resize(nsim);
+  std::vector<double> d1(nareas);
+  for (int s = 0; s < nsim; s++) {
+    long double tot = 0;
+    for (int r = 0; r < nareas; r++) {
+      long double newVB = 0;
+      for (int a = 0; a < maxage; a++) newVB += dyn.CurrentVB[dyn.sar(s, a, r)];
+      dyn.fishdist[s + nsim * r] = R_pow((double) newVB, Spat_targ[s]);
+      tot += dyn.fishdist[s + nsim * r];
+    }
+    long double fracE = 0;
+    for (int r = 0; r < nareas; r++) {
+      d1[r] = Si[r + nareas * s] * (dyn.fishdist[s + nsim * r]/(double) tot);
+      fracE += d1[r];
+    }
+    long double fsum = 0;
+    for (int r = 0; r < nareas; r++) {
+      double fE = (double) fracE;
+      dyn.fishdist[s + nsim * r] = d1[r] * (fE + (1 - fE) * Ai[s])/fE;
+      fsum += dyn.fishdist[s + nsim * r];
+    }
+    dyn.fracE2sum[s] = (double) fsum;
+  }
+
+  NumericVector FM(no_init(n)), FMret(no_init(n)), Z(no_init(n)), CB(no_init(n)), CBret(no_init(n));
+  NumericVector Ftot(nsim), Effort(nsim);
+
+  std::vector<double> Ereq(nsim);
+  if (TACusedE.size() == 0) {
+    // no TAC - fishing mortality with bio-economic effort, and the effort
+    // relative to the last historical year for this catch
+    dyn.effortF(Effort_pot.begin(), FM, FMret);
+    dyn.catchF(FM, FMret, Z, CB, CBret);
+    dyn.totalF(CB, dyn.CurrentVB.data(), Ftot);
+    for (int s = 0; s < nsim; s++) {
+      double qy = R_pow(1 + qinc[s]/100, y);
+      Ereq[s] = Ftot[s]/(FinF[s] * qs[s] * qvar[s] * qy) * dyn.fracE2sum[s];
+    }
+  } else {
+    // effort required to catch the TAC
+    for (int s = 0; s < nsim; s++) Ereq[s] = dyn.tacEffort(s, TACusedE[s]);
+  }
+
+  // limit the effort to the potential effort and the TAE
+  bool anyEpot = false, anyTAE = false;
+  for (int s = 0; s < nsim; s++) {
+    if (!ISNAN(Effort_pot[s])) anyEpot = true;
+    if (!ISNAN(TAE[s])) anyTAE = true;
+  }
+  for (int s = 0; s < nsim; s++) {
+    double Eact = Ereq[s];
+    if (anyEpot && Eact > Effort_pot[s]) Eact = Effort_pot[s];
+    if (anyTAE && Eact > TAE[s]) Eact = TAE[s];
+    if (Eact <= 0) Eact = tiny;
+    Effort[s] = Eact;
+  }
+
+  // fishing mortality and catch with the actual effort
+  dyn.effortF(Effort.begin(), FM, FMret);
+  dyn.catchF(FM, FMret, Z, CB, CBret);
+  dyn.totalF(CB, VBiomass_P.begin(), Ftot);
+
+  IntegerVector odim = IntegerVector::create(nsim, maxage, nareas);
+  FM.attr("dim") = odim;
+  FMret.attr("dim") = odim;
+  Z.attr("dim") = odim;
+  CB.attr("dim") = odim;
+  CBret.attr("dim") = odim;
+  return List::create(Named("FM_P") = FM, Named("FM_Pret") = FMret, Named("Z_P") = Z,
+                      Named("CB_P") = CB, Named("CB_Pret") = CBret,
+                      Named("Effort") = Effort, Named("Ftot") = Ftot);
+}
@@ -0,0 +1,151 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+// At-age and at-length arrays of the operating model (see SampleStockPars and
+// SampleFleetPars). Each array is filled in one pass from the sampled
+// parameters, rather than by indexing with expand.grid or looping over
+// simulations and years in R. The arithmetic is the same as the R code, so the
+// arrays are identical.
+
+// Parameter of simulation s in year y. The parameters are either one value per
+// simulation, or an nsim by nyears matrix.
+static inline double par_sy(const NumericVector& p, int s, int y, int nsim) {
+  return (p.size() == nsim) ? p[s] : p[s + (R_xlen_t) nsim * y];
+}
+
+//' Length-at-age array from von Bertalanffy growth parameters
+//'
+//' @param Linfarray Matrix of Linf with dimensions `c(nsim, nyears)`
+//' @param Karray Matrix of K with dimensions `c(nsim, nyears)`
+//' @param t0 Vector of t0 (nsim long)
+//' @param Agearray Matrix of ages with dimensions `c(nsim, maxage)`
+//'
+//' @return Array of length-at-age with dimensions `c(nsim, maxage, nyears)`
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector vbLenAge(NumericMatrix Linfarray, NumericMatrix Karray, NumericVector t0,
+                       NumericMatrix Agearray) {
+  int nsim = Linfarray.nrow();
+  int nyears = Linfarray.ncol();
+  int maxage = Agearray.ncol();
+  NumericVector out(no_init((R_xlen_t) nsim * maxage * nyears));
+  R_xlen_t i = 0;
+  for (int y = 0; y < nyears; y++) {
+    for (int a = 0; a < maxage; a++) {
+      for (int s = 0; s < nsim; s++) {
+        out[i++] = Linfarray(s, y) * (1 - std::exp(-Karray(s, y) * (Agearray(s, a) - t0[s])));
+      }
+    }
+  }
+  out.attr("dim") = IntegerVector::create(nsim, maxage, nyears);
+  return out;
+}
+
+//' Maturity-at-age array from the ages of 50 and 95 percent maturity
+//'
+//' @param Agearray Matrix of ages with dimensions `c(nsim, maxage)`
+//' @param ageM Matrix of age at 50 percent maturity with dimensions `c(nsim, nyears)`
+//' @param age95 Matrix of age at 95 percent maturity with dimensions `c(nsim, nyears)`
+//'
+//' @return Array of maturity-at-age with dimensions `c(nsim, maxage, nyears)`
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector matAge(NumericMatrix Agearray, NumericMatrix ageM, NumericMatrix age95) {
+  int nsim = ageM.nrow();
+  int nyears = ageM.ncol();
+  int maxage = Agearray.ncol();
+  double l19 = -std::log(19.0);
+  NumericVector out(no_init((R_xlen_t) nsim * maxage * nyears));
+  R_xlen_t i = 0;
+  for (int y = 0; y < nyears; y++) {
+    for (int a = 0; a < maxage; a++) {
+      for (int s = 0; s < nsim; s++) {
+        out[i++] = 1/(1 + std::exp(l19 * ((Agearray(s, a) - ageM(s, y))/(age95(s, y) - ageM(s, y)))));
+      }
+    }
+  }
+  out.attr("dim") = IntegerVector::create(nsim, maxage, nyears);
+  return out;
+}
+
+//' Natural mortality-at-age array from a Lorenzen weight function
+//'
+//' @param Marray Matrix of natural mortality with dimensions `c(nsim, nyears)`
+//' @param Wt_age Array of weight-at-age with dimensions `c(nsim, maxage, nyears)`
+//' @param Winf Vector of asymptotic weight (nsim long)
+//' @param Mexp Vector of Lorenzen exponents (nsim long)
+//'
+//' @return Array of `Marray * (Wt_age/Winf)^Mexp` with dimensions `c(nsim, maxage, nyears)`
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector lorenzenM(NumericMatrix Marray, NumericVector Wt_age, NumericVector Winf,
+                        NumericVector Mexp) {
+  IntegerVector dims = Wt_age.attr("dim");
+  int nsim = dims[0];
+  int maxage = dims[1];
+  int nyears = dims[2];
+  NumericVector out(no_init(Wt_age.size()));
+  R_xlen_t i = 0;
+  for (int y = 0; y < nyears; y++) {
+    for (int a = 0; a < maxage; a++) {
+      for (int s = 0; s < nsim; s++, i++) {
+        out[i] = Marray(s, y) * R_pow(Wt_age[i]/Winf[s], Mexp[s]);
+      }
+    }
+  }
+  out.attr("dim") = dims;
+  return out;
+}
+
+//' Double-normal selectivity curves for all simulations and years
+//'
+//' Equivalent to calling `dnormal` for each simulation and year.
+//'
+//' @param lens Lengths, either a matrix with dimensions `c(nsim, nlen)` that
+//' are the same in each year (e.g. the mid-points of the length bins), or an
+//' array with dimensions `c(nsim, nlen, nyears)` (e.g. length-at-age)
+//' @param lfs Length at full selection. Either one value per simulation or a
+//' matrix with dimensions `c(nsim, nyears)`
+//' @param sls Sigma of the ascending limb, as `lfs`
+//' @param srs Sigma of the descending limb, as `lfs`
+//'
+//' @return An array with dimensions `c(nsim, nlen, nyears)`, or a matrix with
+//' dimensions `c(nsim, nlen)` if `lens` is a matrix and the parameters are
+//' one value per simulation
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector selCurve(NumericVector lens, NumericVector lfs, NumericVector sls, NumericVector srs) {
+  IntegerVector ldim = lens.attr("dim");
+  int nsim = ldim[0];
+  int nlen = ldim[1];
+  int nyears = 1;
+  if (ldim.size() == 3) {
+    nyears = ldim[2];
+  } else {
+    int npar = std::max(lfs.size(), std::max(sls.size(), srs.size()));
+    nyears = npar / nsim;
+  }
+  bool lensyr = ldim.size() == 3;
+  NumericVector out(no_init((R_xlen_t) nsim * nlen * nyears));
+  R_xlen_t i = 0;
+  for (int y = 0; y < nyears; y++) {
+    for (int l = 0; l < nlen; l++) {
+      for (int s = 0; s < nsim; s++, i++) {
+        double len = lensyr ? lens[i] : lens[s + (R_xlen_t) nsim * l];
+        double lf = par_sy(lfs, s, y, nsim);
+        double sig = (len <= lf) ? par_sy(sls, s, y, nsim) : par_sy(srs, s, y, nsim);
+        out[i] = R_pow(2.0, -((len - lf)/sig*(len - lf)/sig));
+      }
+    }
+  }
+  if (ldim.size() == 3 || nyears > 1) {
+    out.attr("dim") = IntegerVector::create(nsim, nlen, nyears);
+  } else {
+    out.attr("dim") = IntegerVector::create(nsim, nlen);
+  }
+  return out;
+}
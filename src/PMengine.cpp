@@ -0,0 +1,103 @@
+#include <Rcpp.h>
+#include <cstdint>
+#include <cstdio>
+using namespace Rcpp;
+
+//' Summarise a projection array for a set of performance metrics
+//'
+//' Calculates the statistics for several performance metrics in a single pass
+//' over an array of projection results (e.g. `MSEobj@B_BMSY`), without creating
+//' the intermediate logical arrays.
+//'
+//' @param x Numeric array with dimensions `c(nsim, nMP, proyears)`
+//' @param type Integer vector with the type of each metric: 0 - proportion of
+//' years where `x/scale > ref`; 1 - proportion of years where `x/scale < ref`;
+//' 2 - mean of `x/scale`; 3 - average annual variability in `x`
+//' @param ref Numeric vector with the reference value for each metric
+//' @param y1 Integer vector with the first projection year for each metric
+//' @param y2 Integer vector with the last projection year for each metric
+//' @param scale Numeric vector of length nsim that `x` is divided by (e.g. reference yield)
+//'
+//' @return A list with an nsim by nMP matrix for each metric. `NA` values are
+//' ignored for types 0 - 2, as in `calcProb`.
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+List PMstats(NumericVector x, IntegerVector type, NumericVector ref,
+             IntegerVector y1, IntegerVector y2, NumericVector scale) {
+  IntegerVector dims = x.attr("dim");
+  int nsim = dims[0];
+  int nMP = dims[1];
+  int ny = dims[2];
+  int nsm = nsim * nMP;
+  int nspec = type.size();
+
+  std::vector<double> num((size_t) nspec * nsm, 0.0);
+  std::vector<double> den((size_t) nspec * nsm, 0.0);
+
+  // years are the slowest-varying dimension, so each year is a contiguous block
+  for (int y = 0; y < ny; y++) {
+    const double* xy = x.begin() + (size_t) y * nsm;
+    for (int k = 0; k < nspec; k++) {
+      if (y < y1[k] - 1 || y > y2[k] - 1) continue;
+      if (type[k] == 3 && y == y1[k] - 1) continue; // variability starts in second year
+      double* nk = &num[(size_t) k * nsm];
+      double* dk = &den[(size_t) k * nsm];
+      for (int j = 0; j < nsm; j++) {
+        double val = xy[j];
+        if (type[k] == 3) {
+          double prev = xy[j - nsm];
+          nk[j] += std::fabs((prev - val) / val);
+          dk[j] += 1;
+          continue;
+        }
+        val /= scale[j % nsim];
+        if (ISNAN(val)) continue;
+        dk[j] += 1;
+        if (type[k] == 0) {
+          if (val > ref[k]) nk[j] += 1;
+        } else if (type[k] == 1) {
+          if (val < ref[k]) nk[j] += 1;
+        } else {
+          nk[j] += val;
+        }
+      }
+    }
+  }
+
+  List out(nspec);
+  for (int k = 0; k < nspec; k++) {
+    NumericMatrix res(nsim, nMP);
+    for (int j = 0; j < nsm; j++) {
+      double d = den[(size_t) k * nsm + j];
+      res[j] = (d > 0) ? num[(size_t) k * nsm + j] / d : R_NaN;
+    }
+    out[k] = res;
+  }
+  return out;
+}
+
+//' Fingerprint of a projection array
+//'
+//' A 64-bit FNV-1a hash of the values of a numeric array, used to check that
+//' the cached performance metric statistics of an MSE object are for the
+//' current values of the array (see `PMcalc`).
+//'
+//' @param x Numeric array
+//'
+//' @return A character string with the length and the hash of `x`
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+std::string PMfingerprint(NumericVector x) {
+  uint64_t h = 14695981039346656037ULL;
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(x.begin());
+  size_t nbytes = (size_t) x.size() * sizeof(double);
+  for (size_t i = 0; i < nbytes; i++) {
+    h ^= p[i];
+    h *= 1099511628211ULL;
+  }
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.0f_%016llx", (double) x.size(), (unsigned long long) h);
+  return std::string(buf);
+}
@@ -6,6 +6,66 @@
 
 using namespace Rcpp;
 
+// getBlowCPP
+NumericVector getBlowCPP(NumericVector N, NumericMatrix Asize, NumericVector SSBMSY, NumericMatrix SSBpR, NumericMatrix MPA, IntegerVector MGThorizon, NumericMatrix Find, NumericMatrix Perr, NumericVector M_ageArray, NumericVector hs, NumericVector Mat_age, NumericVector Wt_age, NumericMatrix R0a, NumericVector V, NumericVector mov, NumericVector Spat_targ, IntegerVector SRrel, NumericMatrix aR, NumericMatrix bR, double Bfrac, double maxF, int plusgroup);
+RcppExport SEXP _DLMtool_getBlowCPP(SEXP NSEXP, SEXP AsizeSEXP, SEXP SSBMSYSEXP, SEXP SSBpRSEXP, SEXP MPASEXP, SEXP MGThorizonSEXP, SEXP FindSEXP, SEXP PerrSEXP, SEXP M_ageArraySEXP, SEXP hsSEXP, SEXP Mat_ageSEXP, SEXP Wt_ageSEXP, SEXP R0aSEXP, SEXP VSEXP, SEXP movSEXP, SEXP Spat_targSEXP, SEXP SRrelSEXP, SEXP aRSEXP, SEXP bRSEXP, SEXP BfracSEXP, SEXP maxFSEXP, SEXP plusgroupSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type N(NSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type Asize(AsizeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type SSBMSY(SSBMSYSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type SSBpR(SSBpRSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type MPA(MPASEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type MGThorizon(MGThorizonSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type Find(FindSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type Perr(PerrSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type M_ageArray(M_ageArraySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type hs(hsSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Mat_age(Mat_ageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Wt_age(Wt_ageSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type R0a(R0aSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type V(VSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type mov(movSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Spat_targ(Spat_targSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type SRrel(SRrelSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type aR(aRSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type bR(bRSEXP);
+    Rcpp::traits::input_parameter< double >::type Bfrac(BfracSEXP);
+    Rcpp::traits::input_parameter< double >::type maxF(maxFSEXP);
+    Rcpp::traits::input_parameter< int >::type plusgroup(plusgroupSEXP);
+    rcpp_result_gen = Rcpp::wrap(getBlowCPP(N, Asize, SSBMSY, SSBpR, MPA, MGThorizon, Find, Perr, M_ageArray, hs, Mat_age, Wt_age, R0a, V, mov, Spat_targ, SRrel, aR, bR, Bfrac, maxF, plusgroup));
+    return rcpp_result_gen;
+END_RCPP
+}
+// CalcMPDynamicsCPP
+List CalcMPDynamicsCPP(NumericVector Biomass_P, NumericVector VBiomass_P, NumericVector V, NumericVector retA, NumericVector M, NumericVector Si, NumericVector Ai, NumericVector TACusedE, NumericVector Effort_pot, NumericVector TAE, NumericVector FinF, NumericVector Spat_targ, NumericVector qvar, NumericVector qs, NumericVector qinc, int y, NumericVector Asize, double maxF);
+RcppExport SEXP _DLMtool_CalcMPDynamicsCPP(SEXP Biomass_PSEXP, SEXP VBiomass_PSEXP, SEXP VSEXP, SEXP retASEXP, SEXP MSEXP, SEXP SiSEXP, SEXP AiSEXP, SEXP TACusedESEXP, SEXP Effort_potSEXP, SEXP TAESEXP, SEXP FinFSEXP, SEXP Spat_targSEXP, SEXP qvarSEXP, SEXP qsSEXP, SEXP qincSEXP, SEXP ySEXP, SEXP AsizeSEXP, SEXP maxFSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type Biomass_P(Biomass_PSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type VBiomass_P(VBiomass_PSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type V(VSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type retA(retASEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type M(MSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Si(SiSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Ai(AiSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type TACusedE(TACusedESEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Effort_pot(Effort_potSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type TAE(TAESEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type FinF(FinFSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Spat_targ(Spat_targSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type qvar(qvarSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type qs(qsSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type qinc(qincSEXP);
+    Rcpp::traits::input_parameter< int >::type y(ySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Asize(AsizeSEXP);
+    Rcpp::traits::input_parameter< double >::type maxF(maxFSEXP);
+    rcpp_result_gen = Rcpp::wrap(CalcMPDynamicsCPP(Biomass_P, VBiomass_P, V, retA, M, Si, Ai, TACusedE, Effort_pot, TAE, FinF, Spat_targ, qvar, qs, qinc, y, Asize, maxF));
+    return rcpp_result_gen;
+END_RCPP
+}
 // LBSPRgen
 List LBSPRgen(double SL50, double SL95, double FM, int nage, int nlen, double CVLinf, NumericVector LenBins, NumericVector LenMids, double MK, double Linf, NumericVector rLens, NumericMatrix Prob, NumericVector Ml, double L50, double L95, double Beta);
 RcppExport SEXP _DLMtool_LBSPRgen(SEXP SL50SEXP, SEXP SL95SEXP, SEXP FMSEXP, SEXP nageSEXP, SEXP nlenSEXP, SEXP CVLinfSEXP, SEXP LenBinsSEXP, SEXP LenMidsSEXP, SEXP MKSEXP, SEXP LinfSEXP, SEXP rLensSEXP, SEXP ProbSEXP, SEXP MlSEXP, SEXP L50SEXP, SEXP L95SEXP, SEXP BetaSEXP) {
@@ -108,6 +168,88 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// vbLenAge
+NumericVector vbLenAge(NumericMatrix Linfarray, NumericMatrix Karray, NumericVector t0, NumericMatrix Agearray);
+RcppExport SEXP _DLMtool_vbLenAge(SEXP LinfarraySEXP, SEXP KarraySEXP, SEXP t0SEXP, SEXP AgearraySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type Linfarray(LinfarraySEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type Karray(KarraySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type t0(t0SEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type Agearray(AgearraySEXP);
+    rcpp_result_gen = Rcpp::wrap(vbLenAge(Linfarray, Karray, t0, Agearray));
+    return rcpp_result_gen;
+END_RCPP
+}
+// matAge
+NumericVector matAge(NumericMatrix Agearray, NumericMatrix ageM, NumericMatrix age95);
+RcppExport SEXP _DLMtool_matAge(SEXP AgearraySEXP, SEXP ageMSEXP, SEXP age95SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type Agearray(AgearraySEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type ageM(ageMSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type age95(age95SEXP);
+    rcpp_result_gen = Rcpp::wrap(matAge(Agearray, ageM, age95));
+    return rcpp_result_gen;
+END_RCPP
+}
+// lorenzenM
+NumericVector lorenzenM(NumericMatrix Marray, NumericVector Wt_age, NumericVector Winf, NumericVector Mexp);
+RcppExport SEXP _DLMtool_lorenzenM(SEXP MarraySEXP, SEXP Wt_ageSEXP, SEXP WinfSEXP, SEXP MexpSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type Marray(MarraySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Wt_age(Wt_ageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Winf(WinfSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Mexp(MexpSEXP);
+    rcpp_result_gen = Rcpp::wrap(lorenzenM(Marray, Wt_age, Winf, Mexp));
+    return rcpp_result_gen;
+END_RCPP
+}
+// selCurve
+NumericVector selCurve(NumericVector lens, NumericVector lfs, NumericVector sls, NumericVector srs);
+RcppExport SEXP _DLMtool_selCurve(SEXP lensSEXP, SEXP lfsSEXP, SEXP slsSEXP, SEXP srsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type lens(lensSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type lfs(lfsSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type sls(slsSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type srs(srsSEXP);
+    rcpp_result_gen = Rcpp::wrap(selCurve(lens, lfs, sls, srs));
+    return rcpp_result_gen;
+END_RCPP
+}
+// PMstats
+List PMstats(NumericVector x, IntegerVector type, NumericVector ref, IntegerVector y1, IntegerVector y2, NumericVector scale);
+RcppExport SEXP _DLMtool_PMstats(SEXP xSEXP, SEXP typeSEXP, SEXP refSEXP, SEXP y1SEXP, SEXP y2SEXP, SEXP scaleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type ref(refSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type y1(y1SEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type y2(y2SEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type scale(scaleSEXP);
+    rcpp_result_gen = Rcpp::wrap(PMstats(x, type, ref, y1, y2, scale));
+    return rcpp_result_gen;
+END_RCPP
+}
+// PMfingerprint
+std::string PMfingerprint(NumericVector x);
+RcppExport SEXP _DLMtool_PMfingerprint(SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(PMfingerprint(x));
+    return rcpp_result_gen;
+END_RCPP
+}
 // bhnoneq_LL
 double bhnoneq_LL(NumericVector stpar, NumericVector year, NumericVector Lbar, NumericVector ss, double Linf, double K, double Lc, int nbreaks);
 RcppExport SEXP _DLMtool_bhnoneq_LL(SEXP stparSEXP, SEXP yearSEXP, SEXP LbarSEXP, SEXP ssSEXP, SEXP LinfSEXP, SEXP KSEXP, SEXP LcSEXP, SEXP nbreaksSEXP) {
@@ -126,6 +268,17 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// fitVBcpp
+List fitVBcpp(NumericVector Len_age);
+RcppExport SEXP _DLMtool_fitVBcpp(SEXP Len_ageSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type Len_age(Len_ageSEXP);
+    rcpp_result_gen = Rcpp::wrap(fitVBcpp(Len_age));
+    return rcpp_result_gen;
+END_RCPP
+}
 // combine
 NumericVector combine(const List& list);
 RcppExport SEXP _DLMtool_combine(SEXP listSEXP) {
@@ -208,6 +361,60 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// genCAA
+NumericVector genCAA(NumericVector Cret, int nsim, int yrs, int maxage, NumericVector CAA_ESS, NumericVector CAA_nsamp);
+RcppExport SEXP _DLMtool_genCAA(SEXP CretSEXP, SEXP nsimSEXP, SEXP yrsSEXP, SEXP maxageSEXP, SEXP CAA_ESSSEXP, SEXP CAA_nsampSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type Cret(CretSEXP);
+    Rcpp::traits::input_parameter< int >::type nsim(nsimSEXP);
+    Rcpp::traits::input_parameter< int >::type yrs(yrsSEXP);
+    Rcpp::traits::input_parameter< int >::type maxage(maxageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type CAA_ESS(CAA_ESSSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type CAA_nsamp(CAA_nsampSEXP);
+    rcpp_result_gen = Rcpp::wrap(genCAA(Cret, nsim, yrs, maxage, CAA_ESS, CAA_nsamp));
+    return rcpp_result_gen;
+END_RCPP
+}
+// CALstats
+List CALstats(NumericVector CAL, NumericVector CAL_binsmid);
+RcppExport SEXP _DLMtool_CALstats(SEXP CALSEXP, SEXP CAL_binsmidSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type CAL(CALSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type CAL_binsmid(CAL_binsmidSEXP);
+    rcpp_result_gen = Rcpp::wrap(CALstats(CAL, CAL_binsmid));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bindSims
+SEXP bindSims(List x, int along, double fill);
+RcppExport SEXP _DLMtool_bindSims(SEXP xSEXP, SEXP alongSEXP, SEXP fillSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type x(xSEXP);
+    Rcpp::traits::input_parameter< int >::type along(alongSEXP);
+    Rcpp::traits::input_parameter< double >::type fill(fillSEXP);
+    rcpp_result_gen = Rcpp::wrap(bindSims(x, along, fill));
+    return rcpp_result_gen;
+END_RCPP
+}
+// mmapReal
+SEXP mmapReal(std::string path, double offset, double n);
+RcppExport SEXP _DLMtool_mmapReal(SEXP pathSEXP, SEXP offsetSEXP, SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< double >::type offset(offsetSEXP);
+    Rcpp::traits::input_parameter< double >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(mmapReal(path, offset, n));
+    return rcpp_result_gen;
+END_RCPP
+}
 // movfit_Rcpp
 double movfit_Rcpp(NumericVector par, double prb, double frac);
 RcppExport SEXP _DLMtool_movfit_Rcpp(SEXP parSEXP, SEXP prbSEXP, SEXP fracSEXP) {
@@ -221,6 +428,19 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// movFitCPP
+NumericVector movFitCPP(NumericMatrix frac, NumericMatrix prb, int maxage);
+RcppExport SEXP _DLMtool_movFitCPP(SEXP fracSEXP, SEXP prbSEXP, SEXP maxageSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type frac(fracSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type prb(prbSEXP);
+    Rcpp::traits::input_parameter< int >::type maxage(maxageSEXP);
+    rcpp_result_gen = Rcpp::wrap(movFitCPP(frac, prb, maxage));
+    return rcpp_result_gen;
+END_RCPP
+}
 // popdynOneTScpp
 arma::mat popdynOneTScpp(double nareas, double maxage, Rcpp::NumericVector SSBcurr, NumericMatrix Ncurr, Rcpp::NumericMatrix Zcurr, double PerrYr, double hs, Rcpp::NumericVector R0a, Rcpp::NumericVector SSBpR, Rcpp::NumericVector aR, Rcpp::NumericVector bR, arma::cube mov, double SRrel, int plusgroup);
 RcppExport SEXP _DLMtool_popdynOneTScpp(SEXP nareasSEXP, SEXP maxageSEXP, SEXP SSBcurrSEXP, SEXP NcurrSEXP, SEXP ZcurrSEXP, SEXP PerrYrSEXP, SEXP hsSEXP, SEXP R0aSEXP, SEXP SSBpRSEXP, SEXP aRSEXP, SEXP bRSEXP, SEXP movSEXP, SEXP SRrelSEXP, SEXP plusgroupSEXP) {
@@ -283,25 +503,158 @@ BEGIN_RCPP
 END_RCPP
 }
 
+// projArray
+SEXP projArray(IntegerVector dims, bool single);
+RcppExport SEXP _DLMtool_projArray(SEXP dimsSEXP, SEXP singleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< IntegerVector >::type dims(dimsSEXP);
+    Rcpp::traits::input_parameter< bool >::type single(singleSEXP);
+    rcpp_result_gen = Rcpp::wrap(projArray(dims, single));
+    return rcpp_result_gen;
+END_RCPP
+}
+// projArraySet
+void projArraySet(SEXP x, int y, NumericVector val);
+RcppExport SEXP _DLMtool_projArraySet(SEXP xSEXP, SEXP ySEXP, SEXP valSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type x(xSEXP);
+    Rcpp::traits::input_parameter< int >::type y(ySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type val(valSEXP);
+    projArraySet(x, y, val);
+    return R_NilValue;
+END_RCPP
+}
+// projArrayGet
+NumericVector projArrayGet(SEXP x, IntegerVector yrs);
+RcppExport SEXP _DLMtool_projArrayGet(SEXP xSEXP, SEXP yrsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type x(xSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type yrs(yrsSEXP);
+    rcpp_result_gen = Rcpp::wrap(projArrayGet(x, yrs));
+    return rcpp_result_gen;
+END_RCPP
+}
+// projArraySum
+NumericVector projArraySum(SEXP x, bool byAge, bool na_rm);
+RcppExport SEXP _DLMtool_projArraySum(SEXP xSEXP, SEXP byAgeSEXP, SEXP na_rmSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type x(xSEXP);
+    Rcpp::traits::input_parameter< bool >::type byAge(byAgeSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    rcpp_result_gen = Rcpp::wrap(projArraySum(x, byAge, na_rm));
+    return rcpp_result_gen;
+END_RCPP
+}
+// getRefYCPP
+NumericVector getRefYCPP(NumericVector N, NumericMatrix Asize, NumericVector M_ageArray, NumericVector Mat_age, NumericVector Wt_age, NumericVector V, NumericMatrix Perr, NumericVector mov, NumericMatrix MPA, IntegerVector SRrel, NumericVector Spat_targ, NumericVector hs, NumericMatrix R0a, NumericMatrix SSBpR, NumericMatrix aR, NumericMatrix bR, int proyears, double maxF, int plusgroup);
+RcppExport SEXP _DLMtool_getRefYCPP(SEXP NSEXP, SEXP AsizeSEXP, SEXP M_ageArraySEXP, SEXP Mat_ageSEXP, SEXP Wt_ageSEXP, SEXP VSEXP, SEXP PerrSEXP, SEXP movSEXP, SEXP MPASEXP, SEXP SRrelSEXP, SEXP Spat_targSEXP, SEXP hsSEXP, SEXP R0aSEXP, SEXP SSBpRSEXP, SEXP aRSEXP, SEXP bRSEXP, SEXP proyearsSEXP, SEXP maxFSEXP, SEXP plusgroupSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type N(NSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type Asize(AsizeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type M_ageArray(M_ageArraySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Mat_age(Mat_ageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Wt_age(Wt_ageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type V(VSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type Perr(PerrSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type mov(movSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type MPA(MPASEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type SRrel(SRrelSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Spat_targ(Spat_targSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type hs(hsSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type R0a(R0aSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type SSBpR(SSBpRSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type aR(aRSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type bR(bRSEXP);
+    Rcpp::traits::input_parameter< int >::type proyears(proyearsSEXP);
+    Rcpp::traits::input_parameter< double >::type maxF(maxFSEXP);
+    Rcpp::traits::input_parameter< int >::type plusgroup(plusgroupSEXP);
+    rcpp_result_gen = Rcpp::wrap(getRefYCPP(N, Asize, M_ageArray, Mat_age, Wt_age, V, Perr, mov, MPA, SRrel, Spat_targ, hs, R0a, SSBpR, aR, bR, proyears, maxF, plusgroup));
+    return rcpp_result_gen;
+END_RCPP
+}
+// subView
+SEXP subView(NumericVector x, List index);
+RcppExport SEXP _DLMtool_subView(SEXP xSEXP, SEXP indexSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< List >::type index(indexSEXP);
+    rcpp_result_gen = Rcpp::wrap(subView(x, index));
+    return rcpp_result_gen;
+END_RCPP
+}
+// unfishedEq
+NumericVector unfishedEq(NumericVector N, NumericVector M_ageArray, NumericVector Wt_age, NumericVector Mat_age, NumericVector mov, NumericVector R0, double tol, int maxit);
+RcppExport SEXP _DLMtool_unfishedEq(SEXP NSEXP, SEXP M_ageArraySEXP, SEXP Wt_ageSEXP, SEXP Mat_ageSEXP, SEXP movSEXP, SEXP R0SEXP, SEXP tolSEXP, SEXP maxitSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type N(NSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type M_ageArray(M_ageArraySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Wt_age(Wt_ageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Mat_age(Mat_ageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type mov(movSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type R0(R0SEXP);
+    Rcpp::traits::input_parameter< double >::type tol(tolSEXP);
+    Rcpp::traits::input_parameter< int >::type maxit(maxitSEXP);
+    rcpp_result_gen = Rcpp::wrap(unfishedEq(N, M_ageArray, Wt_age, Mat_age, mov, R0, tol, maxit));
+    return rcpp_result_gen;
+END_RCPP
+}
 static const R_CallMethodDef CallEntries[] = {
+    {"_DLMtool_getBlowCPP", (DL_FUNC) &_DLMtool_getBlowCPP, 22},
+    {"_DLMtool_CalcMPDynamicsCPP", (DL_FUNC) &_DLMtool_CalcMPDynamicsCPP, 18},
     {"_DLMtool_LBSPRgen", (DL_FUNC) &_DLMtool_LBSPRgen, 16},
     {"_DLMtool_LBSPRopt", (DL_FUNC) &_DLMtool_LBSPRopt, 15},
     {"_DLMtool_LSRA_opt_cpp", (DL_FUNC) &_DLMtool_LSRA_opt_cpp, 10},
     {"_DLMtool_LSRA_MCMC_sim", (DL_FUNC) &_DLMtool_LSRA_MCMC_sim, 21},
+    {"_DLMtool_vbLenAge", (DL_FUNC) &_DLMtool_vbLenAge, 4},
+    {"_DLMtool_matAge", (DL_FUNC) &_DLMtool_matAge, 3},
+    {"_DLMtool_lorenzenM", (DL_FUNC) &_DLMtool_lorenzenM, 4},
+    {"_DLMtool_selCurve", (DL_FUNC) &_DLMtool_selCurve, 4},
+    {"_DLMtool_PMstats", (DL_FUNC) &_DLMtool_PMstats, 6},
+    {"_DLMtool_PMfingerprint", (DL_FUNC) &_DLMtool_PMfingerprint, 1},
     {"_DLMtool_bhnoneq_LL", (DL_FUNC) &_DLMtool_bhnoneq_LL, 8},
+    {"_DLMtool_fitVBcpp", (DL_FUNC) &_DLMtool_fitVBcpp, 1},
     {"_DLMtool_combine", (DL_FUNC) &_DLMtool_combine, 1},
     {"_DLMtool_get_freq", (DL_FUNC) &_DLMtool_get_freq, 4},
     {"_DLMtool_which_maxC", (DL_FUNC) &_DLMtool_which_maxC, 1},
     {"_DLMtool_rnormSelect2", (DL_FUNC) &_DLMtool_rnormSelect2, 3},
     {"_DLMtool_tdnorm", (DL_FUNC) &_DLMtool_tdnorm, 3},
     {"_DLMtool_genSizeComp", (DL_FUNC) &_DLMtool_genSizeComp, 10},
+    {"_DLMtool_genCAA", (DL_FUNC) &_DLMtool_genCAA, 6},
+    {"_DLMtool_CALstats", (DL_FUNC) &_DLMtool_CALstats, 2},
+    {"_DLMtool_bindSims", (DL_FUNC) &_DLMtool_bindSims, 3},
+    {"_DLMtool_mmapReal", (DL_FUNC) &_DLMtool_mmapReal, 3},
     {"_DLMtool_movfit_Rcpp", (DL_FUNC) &_DLMtool_movfit_Rcpp, 3},
+    {"_DLMtool_movFitCPP", (DL_FUNC) &_DLMtool_movFitCPP, 3},
     {"_DLMtool_popdynOneTScpp", (DL_FUNC) &_DLMtool_popdynOneTScpp, 14},
     {"_DLMtool_popdynCPP", (DL_FUNC) &_DLMtool_popdynCPP, 27},
+    {"_DLMtool_projArray", (DL_FUNC) &_DLMtool_projArray, 2},
+    {"_DLMtool_projArraySet", (DL_FUNC) &_DLMtool_projArraySet, 3},
+    {"_DLMtool_projArrayGet", (DL_FUNC) &_DLMtool_projArrayGet, 2},
+    {"_DLMtool_projArraySum", (DL_FUNC) &_DLMtool_projArraySum, 3},
+    {"_DLMtool_getRefYCPP", (DL_FUNC) &_DLMtool_getRefYCPP, 19},
+    {"_DLMtool_subView", (DL_FUNC) &_DLMtool_subView, 2},
+    {"_DLMtool_unfishedEq", (DL_FUNC) &_DLMtool_unfishedEq, 8},
     {NULL, NULL, 0}
 };
 
+void init_mmap_real(DllInfo* dll);
+void init_view_real(DllInfo* dll);
 RcppExport void R_init_DLMtool(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    init_mmap_real(dll);
+    init_view_real(dll);
 }
@@ -0,0 +1,94 @@
+#ifndef DLMTOOL_BRENT_H
+#define DLMTOOL_BRENT_H
+
+#include <cmath>
+#include <cfloat>
+#include <R_ext/Arith.h>
+
+// Brent's one-dimensional minimiser. The same algorithm and stopping rule as
+// stats::optimize (Brent_fmin in R), so for the same objective the solutions
+// match those of the R code. Non-finite values of the objective are replaced
+// by the maximum double, as in optimize.
+// f: function object with double operator()(double)
+template <typename F>
+double brent_fmin(double ax, double bx, F& f, double tol = std::pow(DBL_EPSILON, 0.25)) {
+  const double c = (3. - std::sqrt(5.)) * .5;
+  double a, b, d, e, p, q, r, u, v, w, x;
+  double t2, fu, fv, fw, fx, xm, eps, tol1, tol3;
+
+  eps = std::sqrt(DBL_EPSILON);
+  a = ax;
+  b = bx;
+  v = a + c * (b - a);
+  w = v;
+  x = v;
+
+  d = 0.;
+  e = 0.;
+  fx = f(x);
+  if (!R_FINITE(fx)) fx = DBL_MAX;
+  fv = fx;
+  fw = fx;
+  tol3 = tol / 3.;
+
+  for (;;) {
+    xm = (a + b) * .5;
+    tol1 = eps * std::fabs(x) + tol3;
+    t2 = tol1 * 2.;
+    // check stopping criterion
+    if (std::fabs(x - xm) <= t2 - (b - a) * .5) break;
+    p = 0.;
+    q = 0.;
+    r = 0.;
+    if (std::fabs(e) > tol1) { // fit parabola
+      r = (x - w) * (fx - fv);
+      q = (x - v) * (fx - fw);
+      p = (x - v) * q - (x - w) * r;
+      q = (q - r) * 2.;
+      if (q > 0.) p = -p; else q = -q;
+      r = e;
+      e = d;
+    }
+    if (std::fabs(p) >= std::fabs(q * .5 * r) || p <= q * (a - x) || p >= q * (b - x)) {
+      // a golden-section step
+      if (x < xm) e = b - x; else e = a - x;
+      d = c * e;
+    } else {
+      // a parabolic-interpolation step
+      d = p / q;
+      u = x + d;
+      // f must not be evaluated too close to ax or bx
+      if (u - a < t2 || b - u < t2) {
+        d = tol1;
+        if (x >= xm) d = -d;
+      }
+    }
+    // f must not be evaluated too close to x
+    if (std::fabs(d) >= tol1) {
+      u = x + d;
+    } else if (d > 0.) {
+      u = x + tol1;
+    } else {
+      u = x - tol1;
+    }
+    fu = f(u);
+    if (!R_FINITE(fu)) fu = DBL_MAX;
+    // update a, b, v, w, and x
+    if (fu <= fx) {
+      if (u < x) b = x; else a = x;
+      v = w; w = x; x = u;
+      fv = fw; fw = fx; fx = fu;
+    } else {
+      if (u < x) a = u; else b = u;
+      if (fu <= fw || w == x) {
+        v = w; fv = fw;
+        w = u; fw = fu;
+      } else if (fu <= fv || v == x || v == w) {
+        v = u; fv = fu;
+      }
+    }
+  }
+  return x;
+}
+
+#endif
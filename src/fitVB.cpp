@@ -0,0 +1,140 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+// Least-squares fit of the von Bertalanffy growth curve
+// L = Linf * (1 - exp(-K * (age - t0))), written as L = alpha + beta * exp(-K * age).
+// For a given K the curve is linear in alpha and beta, so these are solved
+// directly and only K is searched.
+
+struct VBfit {
+  double Linf;
+  double K;
+  double t0;
+  double ss;
+};
+
+static VBfit vb_profile(const std::vector<double>& age, const std::vector<double>& len, double K) {
+  int n = age.size();
+  std::vector<double> x(n);
+  double sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (int i = 0; i < n; i++) {
+    x[i] = std::exp(-K * age[i]);
+    sx += x[i];
+    sy += len[i];
+    sxx += x[i] * x[i];
+    sxy += x[i] * len[i];
+  }
+  VBfit fit;
+  fit.K = K;
+  double det = n * sxx - sx * sx;
+  if (!(det > 1e-300)) {
+    fit.Linf = fit.t0 = NA_REAL;
+    fit.ss = R_PosInf;
+    return fit;
+  }
+  double beta = (n * sxy - sx * sy) / det;
+  double alpha = (sy - beta * sx) / n;
+  fit.ss = 0;
+  for (int i = 0; i < n; i++) {
+    double r = len[i] - alpha - beta * x[i];
+    fit.ss += r * r;
+  }
+  fit.Linf = alpha;
+  // beta = -Linf * exp(K * t0)
+  fit.t0 = (alpha > 0 && beta < 0) ? std::log(-beta / alpha) / K : 0;
+  return fit;
+}
+
+// Grid search over log(K) followed by a golden-section search between the
+// neighbours of the best grid point
+static VBfit vb_fit(const std::vector<double>& age, const std::vector<double>& len) {
+  const int ngrid = 60;
+  const double lo = std::log(1e-3), hi = std::log(5.0);
+  const double step = (hi - lo) / (ngrid - 1);
+  VBfit best = vb_profile(age, len, std::exp(lo));
+  int ibest = 0;
+  for (int i = 1; i < ngrid; i++) {
+    VBfit f = vb_profile(age, len, std::exp(lo + i * step));
+    if (f.ss < best.ss) {
+      best = f;
+      ibest = i;
+    }
+  }
+  double a = lo + std::max(ibest - 1, 0) * step;
+  double b = lo + std::min(ibest + 1, ngrid - 1) * step;
+  const double gr = (std::sqrt(5.0) - 1) / 2;
+  double c = b - gr * (b - a);
+  double d = a + gr * (b - a);
+  VBfit fc = vb_profile(age, len, std::exp(c));
+  VBfit fd = vb_profile(age, len, std::exp(d));
+  while (b - a > 1e-8) {
+    if (fc.ss < fd.ss) {
+      b = d;
+      d = c;
+      fd = fc;
+      c = b - gr * (b - a);
+      fc = vb_profile(age, len, std::exp(c));
+    } else {
+      a = c;
+      c = d;
+      fc = fd;
+      d = a + gr * (b - a);
+      fd = vb_profile(age, len, std::exp(d));
+    }
+  }
+  if (fc.ss < best.ss) best = fc;
+  if (fd.ss < best.ss) best = fd;
+  return best;
+}
+
+//' Fit von Bertalanffy growth curves to length-at-age
+//'
+//' Fits the growth curve by least squares to the length-at-age of each
+//' simulation and year. For a given K the curve is linear in Linf and
+//' Linf*exp(K*t0), so these are calculated directly and only K is searched.
+//' Years with the same length-at-age as the previous year are not refitted.
+//'
+//' @param Len_age Numeric array of length-at-age with dimensions
+//' `c(nsim, maxage, nyears)`
+//'
+//' @return A list with `nsim` by `nyears` matrices `Linf`, `K` and `t0`
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+List fitVBcpp(NumericVector Len_age) {
+  IntegerVector dims = Len_age.attr("dim");
+  if (dims.size() != 3) stop("`Len_age` must be an array with dimensions nsim, maxage, nyears");
+  int nsim = dims[0];
+  int maxage = dims[1];
+  int nyears = dims[2];
+  NumericMatrix Linf(nsim, nyears), K(nsim, nyears), t0(nsim, nyears);
+
+  std::vector<double> age, len, prev;
+  for (int s = 0; s < nsim; s++) {
+    prev.clear();
+    VBfit fit;
+    for (int y = 0; y < nyears; y++) {
+      std::vector<double> cur(maxage);
+      for (int a = 0; a < maxage; a++) cur[a] = Len_age[s + (size_t) nsim * (a + (size_t) maxage * y)];
+      if (cur != prev) {
+        age.clear();
+        len.clear();
+        for (int a = 0; a < maxage; a++) {
+          if (!R_FINITE(cur[a])) continue;
+          age.push_back(a + 1);
+          len.push_back(cur[a]);
+        }
+        if (age.size() < 3) {
+          fit.Linf = fit.K = fit.t0 = NA_REAL;
+        } else {
+          fit = vb_fit(age, len);
+        }
+        prev = cur;
+      }
+      Linf(s, y) = fit.Linf;
+      K(s, y) = fit.K;
+      t0(s, y) = fit.t0;
+    }
+  }
+  return List::create(Named("Linf") = Linf, Named("K") = K, Named("t0") = t0);
+}
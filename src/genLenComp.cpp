@@ -154,6 +154,141 @@ NumericMatrix  genSizeComp(NumericMatrix VulnN, NumericVector CAL_binsmid, Numer
 }
 
 
+//' Multinomial observation model for catch-at-age
+//'
+//' The core of `simCAA`. The samples are drawn in the same order and with the
+//' same algorithm as `rmultinom`, so the result is identical to drawing from
+//' `rmultinom` for each simulation and year.
+//'
+//' @param Cret Retained catch-at-age in numbers - array(nsim, yrs, maxage)
+//' @param nsim Number of simulations
+//' @param yrs Number of years
+//' @param maxage Maximum age
+//' @param CAA_ESS Vector (nsim long) of CAA effective sample size
+//' @param CAA_nsamp Vector (nsim long) of CAA sample size
+//'
+//' @return CAA array with dimensions `c(nsim, yrs, maxage)`
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector genCAA(NumericVector Cret, int nsim, int yrs, int maxage,
+                     NumericVector CAA_ESS, NumericVector CAA_nsamp) {
+  NumericVector CAA(nsim * yrs * maxage);
+  std::vector<double> prob(maxage);
+  std::vector<int> rN(maxage);
+  for (int i=0; i < nsim; i++) {
+    int size = CAA_ESS(i); // rmultinom truncates size to an integer
+    for (int j=0; j < yrs; j++) {
+      double Ctot = 0;
+      double psum = 0;
+      for (int a=0; a < maxage; a++) {
+        prob[a] = Cret(i + j*nsim + a*nsim*yrs);
+        if (ISNAN(prob[a]) || prob[a] < 0) stop("retained catch-at-age must be positive");
+        Ctot += prob[a];
+        if (prob[a] > 0) psum += prob[a];
+        rN[a] = 0;
+      }
+      if (Ctot == 0 || size == 0) continue; // no catch - CAA is zero
+      
+      long double p_tot = 0;
+      for (int a=0; a < maxage; a++) {
+        prob[a] = prob[a]/psum;
+        p_tot += prob[a];
+      }
+      // conditional binomial draws
+      int n = size;
+      int a = 0;
+      for (; a < maxage-1; a++) {
+        if (prob[a] != 0) {
+          double pp = (double) (prob[a]/p_tot);
+          rN[a] = (pp < 1.) ? (int) R::rbinom((double) n, pp) : n;
+          n -= rN[a];
+        }
+        if (n <= 0) break;
+        p_tot -= prob[a];
+      }
+      if (a == maxage-1) rN[maxage-1] = n;
+      
+      for (int a=0; a < maxage; a++) 
+        CAA(i + j*nsim + a*nsim*yrs) = ceil(-0.5 + rN[a] * CAA_nsamp(i)/CAA_ESS(i));
+    }
+  }
+  CAA.attr("dim") = IntegerVector::create(nsim, yrs, maxage);
+  return(CAA);
+}
+
+
+//' Summary statistics of the catch-at-length data
+//'
+//' The mean length, modal length and mean length above the modal length for
+//' each simulation and year, as calculated by `simCAL`.
+//'
+//' @param CAL Catch-at-length array with dimensions `c(nsim, nyears, nbins)`
+//' @param CAL_binsmid Mid-points of the length bins
+//'
+//' @return A named list of nsim by nyears matrices: `ML` (mean length), `Lc`
+//' (modal length) and `Lbar` (mean length above the modal length)
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+List CALstats(NumericVector CAL, NumericVector CAL_binsmid) {
+  IntegerVector dims = CAL.attr("dim");
+  int nsy = dims[0] * dims[1]; // simulations x years
+  int nbins = dims[2];
+  // sums are accumulated in long double, as sum() in R
+  std::vector<long double> Ctot(nsy, 0.0), Ltot(nsy, 0.0);
+  NumericVector Cmax(nsy, R_NegInf);
+  IntegerVector maxbin(nsy);
+  
+  for (int b=0; b < nbins; b++) {
+    const double* Cb = CAL.begin() + (R_xlen_t) b * nsy;
+    for (int k=0; k < nsy; k++) {
+      Ctot[k] += Cb[k];
+      Ltot[k] += Cb[k] * CAL_binsmid(b);
+      if (Cb[k] > Cmax(k)) { // first maximum, as which.max
+        Cmax(k) = Cb[k];
+        maxbin(k) = b;
+      }
+    }
+  }
+  
+  // bins from the modal length (or length 1 for modal lengths < 1) are
+  // used for Lbar
+  int onebin = -1;
+  for (int b=0; b < nbins; b++) {
+    if (CAL_binsmid(b) == 1) {
+      onebin = b;
+      break;
+    }
+  }
+  NumericMatrix ML(dims[0], dims[1]), Lc(dims[0], dims[1]), Lbar(dims[0], dims[1]);
+  IntegerVector lcbin(nsy);
+  for (int k=0; k < nsy; k++) {
+    ML(k) = (double) Ltot[k]/(double) Ctot[k];
+    if (!R_FINITE(ML(k))) ML(k) = 0;
+    Lc(k) = CAL_binsmid(maxbin(k));
+    int m = (Lc(k) < 1) ? onebin : maxbin(k);
+    lcbin(k) = (m < 1) ? 1 : m;
+  }
+  
+  std::vector<long double> Cabove(nsy, 0.0), Labove(nsy, 0.0);
+  for (int b=1; b < nbins; b++) {
+    const double* Cb = CAL.begin() + (R_xlen_t) b * nsy;
+    for (int k=0; k < nsy; k++) {
+      if (b < lcbin(k)) continue;
+      Cabove[k] += Cb[k];
+      Labove[k] += Cb[k] * CAL_binsmid(b);
+    }
+  }
+  for (int k=0; k < nsy; k++) {
+    Lbar(k) = (double) Labove[k]/(double) Cabove[k];
+    if (!R_FINITE(Lbar(k))) Lbar(k) = 0;
+  }
+  
+  return(List::create(Named("ML")=ML, Named("Lc")=Lc, Named("Lbar")=Lbar));
+}
+
+
 // // [[Rcpp::export]]
 // NumericMatrix  genSizeComp2(NumericMatrix VulnN, NumericVector CAL_binsmid, 
 //                            double CAL_ESS, double CAL_nsamp,
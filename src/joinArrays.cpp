@@ -0,0 +1,99 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+// Copy each array into its slice of the output. Columns (runs along the first
+// dimension) are contiguous in both the input and the output, so they are
+// copied as blocks.
+template <int RTYPE>
+SEXP bind_arrays(const List& x, const IntegerVector& outdim, int along, double fill) {
+  int nd = outdim.size();
+  R_xlen_t n = 1;
+  std::vector<R_xlen_t> mult(nd);
+  for (int k = 0; k < nd; k++) {
+    mult[k] = n;
+    n *= outdim[k];
+  }
+
+  Vector<RTYPE> out(no_init(n));
+  typedef typename traits::storage_type<RTYPE>::type stored_type;
+  stored_type fillval;
+  if (RTYPE == REALSXP) {
+    fillval = fill;
+  } else {
+    fillval = ISNAN(fill) ? NA_INTEGER : (int) fill;
+  }
+  std::fill(out.begin(), out.end(), fillval);
+
+  R_xlen_t st = 0;
+  for (int i = 0; i < x.size(); i++) {
+    Vector<RTYPE> xi = x[i];
+    IntegerVector d = xi.attr("dim");
+    if (d[0] > 0) {
+      R_xlen_t ncol = xi.size() / d[0];
+      std::vector<int> idx(nd, 0);
+      for (R_xlen_t c = 0; c < ncol; c++) {
+        R_xlen_t off = (along == 0) ? st : 0;
+        for (int k = 1; k < nd; k++) off += (idx[k] + ((k == along) ? st : 0)) * mult[k];
+        std::copy(xi.begin() + c * d[0], xi.begin() + (c + 1) * d[0], out.begin() + off);
+        for (int k = 1; k < nd; k++) {
+          if (++idx[k] < d[k]) break;
+          idx[k] = 0;
+        }
+      }
+    }
+    st += d[along];
+  }
+  out.attr("dim") = outdim;
+  return out;
+}
+
+//' Join a list of arrays along one dimension
+//'
+//' The dimensions of the output are calculated first and the array is
+//' allocated once. Each array is then copied into its slice of the output.
+//' Arrays that are smaller than the output in the other dimensions are padded
+//' with `fill`.
+//'
+//' @param x A list of logical, integer or numeric arrays with the same number
+//' of dimensions
+//' @param along The dimension to join along (e.g. 1 for simulations)
+//' @param fill Value for the padded elements
+//'
+//' @return An array of the highest type in `x`
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+SEXP bindSims(List x, int along, double fill) {
+  if (x.size() < 1) stop("no arrays to join");
+  RObject x0 = x[0];
+  if (!x0.hasAttribute("dim")) stop("all elements must be arrays");
+  IntegerVector dim0 = x0.attr("dim");
+  int nd = dim0.size();
+  if (along < 1 || along > nd) stop("`along` is not a dimension of the arrays");
+  along -= 1;
+
+  IntegerVector outdim(nd, 0);
+  int rtype = LGLSXP;
+  for (int i = 0; i < x.size(); i++) {
+    RObject xi = x[i];
+    if (!xi.hasAttribute("dim")) stop("all elements must be arrays");
+    IntegerVector d = xi.attr("dim");
+    if (d.size() != nd) stop("arrays have a different number of dimensions");
+    for (int k = 0; k < nd; k++) {
+      if (k == along) {
+        outdim[k] += d[k];
+      } else if (d[k] > outdim[k]) {
+        outdim[k] = d[k];
+      }
+    }
+    int t = TYPEOF(xi);
+    if (t != LGLSXP && t != INTSXP && t != REALSXP) stop("arrays must be logical, integer or numeric");
+    if (t == REALSXP || (t == INTSXP && rtype == LGLSXP)) rtype = t;
+  }
+
+  switch (rtype) {
+  case LGLSXP: return bind_arrays<LGLSXP>(x, outdim, along, fill);
+  case INTSXP: return bind_arrays<INTSXP>(x, outdim, along, fill);
+  default: return bind_arrays<REALSXP>(x, outdim, along, fill);
+  }
+}
@@ -0,0 +1,154 @@
+#include <Rcpp.h>
+#include <Rversion.h>
+#include <cstdio>
+using namespace Rcpp;
+
+// Memory-mapped numeric vectors used by the historical simulation store
+// (see R/HistStore.R). On platforms with mmap the vectors are ALTREP objects
+// that point directly into the mapped file, so all processes on a node share
+// the same physical pages. Elsewhere the block is read into a regular vector.
+
+#if !defined(_WIN32) && defined(R_VERSION) && R_VERSION >= R_Version(3, 5, 0)
+#define DLM_MMAP 1
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if R_VERSION < R_Version(3, 6, 0)
+// R_ext/Altrep.h in R 3.5 uses 'class' as a variable name and does not
+// declare its functions extern "C"
+#define class klass
+extern "C" {
+#include <R_ext/Altrep.h>
+}
+#undef class
+#else
+#include <R_ext/Altrep.h>
+#endif
+
+struct MappedBlock {
+  void *addr;
+  size_t size;
+};
+
+static R_altrep_class_t mmap_real_class;
+
+static void mmap_finalize(SEXP ptr) {
+  MappedBlock *blk = (MappedBlock *) R_ExternalPtrAddr(ptr);
+  if (blk == NULL) return;
+  munmap(blk->addr, blk->size);
+  delete blk;
+  R_ClearExternalPtr(ptr);
+}
+
+// data1: external pointer to the mapping
+// data2: c(byte offset of the first element in the mapping, length)
+static double *mmap_real_ptr(SEXP x) {
+  MappedBlock *blk = (MappedBlock *) R_ExternalPtrAddr(R_altrep_data1(x));
+  if (blk == NULL) Rf_error("memory-mapped vector has been released");
+  double *info = REAL(R_altrep_data2(x));
+  return (double *) ((char *) blk->addr + (size_t) info[0]);
+}
+
+static R_xlen_t mmap_real_length(SEXP x) {
+  return (R_xlen_t) REAL(R_altrep_data2(x))[1];
+}
+
+static Rboolean mmap_real_inspect(SEXP x, int pre, int deep, int pvec,
+                                  void (*inspect_subtree)(SEXP, int, int, int)) {
+  Rprintf("mmap_real (len=%.0f)\n", (double) mmap_real_length(x));
+  return TRUE;
+}
+
+// MAP_PRIVATE: writes (if R ever asks for a writeable pointer) are copy-on-write
+// and never reach the file or the other processes
+static void *mmap_real_dataptr(SEXP x, Rboolean writeable) {
+  return (void *) mmap_real_ptr(x);
+}
+
+static const void *mmap_real_dataptr_or_null(SEXP x) {
+  return (const void *) mmap_real_ptr(x);
+}
+
+static double mmap_real_elt(SEXP x, R_xlen_t i) {
+  return mmap_real_ptr(x)[i];
+}
+
+static R_xlen_t mmap_real_get_region(SEXP x, R_xlen_t i, R_xlen_t n, double *buf) {
+  R_xlen_t len = mmap_real_length(x);
+  R_xlen_t ncopy = (len - i > n) ? n : len - i;
+  double *ptr = mmap_real_ptr(x);
+  for (R_xlen_t k = 0; k < ncopy; k++) buf[k] = ptr[i + k];
+  return ncopy;
+}
+#endif
+
+// Register the ALTREP class when the package is loaded
+// [[Rcpp::init]]
+void init_mmap_real(DllInfo *dll) {
+#ifdef DLM_MMAP
+  mmap_real_class = R_make_altreal_class("mmap_real", "DLMtool", dll);
+  R_set_altrep_Length_method(mmap_real_class, mmap_real_length);
+  R_set_altrep_Inspect_method(mmap_real_class, mmap_real_inspect);
+  R_set_altvec_Dataptr_method(mmap_real_class, mmap_real_dataptr);
+  R_set_altvec_Dataptr_or_null_method(mmap_real_class, mmap_real_dataptr_or_null);
+  R_set_altreal_Elt_method(mmap_real_class, mmap_real_elt);
+  R_set_altreal_Get_region_method(mmap_real_class, mmap_real_get_region);
+#endif
+}
+
+//' Read a block of doubles from a binary file
+//'
+//' Returns `n` doubles starting at element `offset` (0-based) of a file written
+//' with `writeBin`. Where memory-mapping is available the result is a read-only
+//' view of the file and no data are copied.
+//'
+//' @param path Full path to the binary file
+//' @param offset Number of doubles to skip from the start of the file
+//' @param n Number of doubles to return
+//'
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+SEXP mmapReal(std::string path, double offset, double n) {
+  size_t off = (size_t) offset * sizeof(double);
+  size_t nbytes = (size_t) n * sizeof(double);
+  if (nbytes == 0) return Rf_allocVector(REALSXP, 0);
+
+#ifdef DLM_MMAP
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) stop("Could not open " + path);
+  // mmap offsets must be a multiple of the page size
+  size_t page = (size_t) sysconf(_SC_PAGESIZE);
+  size_t start = off - off % page;
+  size_t size = nbytes + (off - start);
+  void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t) start);
+  close(fd);
+  if (addr == MAP_FAILED) stop("Could not memory-map " + path);
+
+  MappedBlock *blk = new MappedBlock;
+  blk->addr = addr;
+  blk->size = size;
+  SEXP ptr = PROTECT(R_MakeExternalPtr(blk, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, mmap_finalize, TRUE);
+  SEXP info = PROTECT(Rf_allocVector(REALSXP, 2));
+  REAL(info)[0] = (double) (off - start);
+  REAL(info)[1] = n;
+  SEXP out = R_new_altrep(mmap_real_class, ptr, info);
+  UNPROTECT(2);
+  return out;
+#else
+  NumericVector out((R_xlen_t) n);
+  FILE *f = fopen(path.c_str(), "rb");
+  if (f == NULL) stop("Could not open " + path);
+#ifdef _WIN32
+  int err = _fseeki64(f, (__int64) off, SEEK_SET);
+#else
+  int err = fseek(f, (long) off, SEEK_SET);
+#endif
+  size_t nread = (err == 0) ? fread(out.begin(), sizeof(double), (size_t) n, f) : 0;
+  fclose(f);
+  if (nread != (size_t) n) stop("Could not read " + path);
+  return out;
+#endif
+}
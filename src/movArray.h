@@ -0,0 +1,42 @@
+#ifndef DLMTOOL_MOVARRAY_H
+#define DLMTOOL_MOVARRAY_H
+
+#include <Rcpp.h>
+#include <vector>
+
+// Movement of all simulations. The movement matrices are stored once for each
+// unique year with dimensions c(nsim, maxage, nareas, nareas, nunique) and the
+// "year" attribute (1-based) gives the matrices used in each year (see
+// compactMov). Arrays without the attribute have one set of matrices per year,
+// and arrays with 4 dimensions are the same in all years.
+struct MovArray {
+  const double* x;
+  size_t nsim, maxage, nareas, nslice;
+  std::vector<int> yr;
+
+  MovArray(const Rcpp::NumericVector& mov) : x(mov.begin()) {
+    Rcpp::IntegerVector d = mov.attr("dim");
+    nsim = d[0];
+    maxage = d[1];
+    nareas = d[2];
+    nslice = (d.size() > 4) ? d[4] : 1;
+    if (mov.hasAttribute("year")) {
+      Rcpp::IntegerVector y = mov.attr("year");
+      yr.assign(y.begin(), y.end());
+      for (size_t i = 0; i < yr.size(); i++) yr[i] -= 1;
+    }
+  }
+
+  // index of the movement matrices of year y (0-based)
+  inline size_t slice(int y) const {
+    if (!yr.empty()) return yr[y];
+    return (nslice > 1) ? (size_t) y : 0;
+  }
+
+  // probability of moving from area `from` to area `to` for simulation s, age a and year y
+  inline double operator()(int s, int a, int from, int to, int y) const {
+    return x[s + nsim * (a + maxage * (from + nareas * (to + nareas * slice(y))))];
+  }
+};
+
+#endif
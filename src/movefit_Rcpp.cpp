@@ -1,4 +1,5 @@
 #include <Rcpp.h>
+#include <R_ext/Applic.h>
 using namespace Rcpp;
 
 //' Rcpp version of the Optimization function that returns the squared difference between user
@@ -63,3 +64,126 @@ double  movfit_Rcpp(NumericVector par, double prb, double frac) {
 
 
 
+
+// Movement model for any number of areas. The probability of staying in area i
+// is p_i and individuals that leave area i move to area j in proportion to the
+// attractiveness g_j of the other areas. The parameters (logit p_i and log g_j
+// relative to area 1) are estimated with Nelder-Mead so that the probability of
+// staying and the stationary distribution match the user specified values.
+struct MovFit {
+  int n;
+  const double *frac, *prb;  // nareas long, prb is NA if not specified
+  std::vector<double> P, A, pi;
+
+  MovFit(int n) : n(n), P(n * n), A(n * n), pi(n) {}
+
+  // movement matrix (from area i to area j in P[i + n * j]) from the parameters
+  void movmat(const double* par) {
+    std::vector<double> g(n, 1.0);
+    if (n > 2) for (int j = 1; j < n; j++) g[j] = std::exp(par[n + j - 1]);
+    for (int i = 0; i < n; i++) {
+      double p = 1/(1 + std::exp(-par[i]));
+      double tot = 0;
+      for (int j = 0; j < n; j++) if (j != i) tot += g[j];
+      for (int j = 0; j < n; j++) P[i + n * j] = (j == i) ? p : (1 - p) * g[j]/tot;
+    }
+  }
+
+  // stationary distribution: solve pi (P - I) = 0 with sum(pi) = 1
+  void stationary() {
+    for (int r = 0; r < n; r++) {
+      for (int c = 0; c < n; c++) {
+        A[r + n * c] = (r == n - 1) ? 1.0 : P[c + n * r] - (r == c ? 1.0 : 0.0);
+      }
+      pi[r] = (r == n - 1) ? 1.0 : 0.0;
+    }
+    for (int c = 0; c < n; c++) {
+      int piv = c;
+      for (int r = c + 1; r < n; r++) if (std::fabs(A[r + n * c]) > std::fabs(A[piv + n * c])) piv = r;
+      if (piv != c) {
+        for (int k = 0; k < n; k++) std::swap(A[c + n * k], A[piv + n * k]);
+        std::swap(pi[c], pi[piv]);
+      }
+      for (int r = c + 1; r < n; r++) {
+        double f = A[r + n * c]/A[c + n * c];
+        for (int k = c; k < n; k++) A[r + n * k] -= f * A[c + n * k];
+        pi[r] -= f * pi[c];
+      }
+    }
+    for (int r = n - 1; r >= 0; r--) {
+      for (int k = r + 1; k < n; k++) pi[r] -= A[r + n * k] * pi[k];
+      pi[r] /= A[r + n * r];
+    }
+  }
+
+  double objective(const double* par) {
+    movmat(par);
+    stationary();
+    double NLL = 0;
+    for (int i = 0; i < n; i++) {
+      if (!ISNAN(prb[i])) NLL += std::pow(std::log(P[i + n * i]) - std::log(prb[i]), 2);
+      NLL += std::pow(std::log(frac[i]) - std::log(pi[i]), 2);
+    }
+    return R_FINITE(NLL) ? NLL : 1e10;
+  }
+};
+
+static double movfit_fn(int npar, double* par, void* ex) {
+  return static_cast<MovFit*>(ex)->objective(par);
+}
+
+//' Fit movement matrices for any number of areas
+//'
+//' The n-area version of `movfit_Rcpp` and `getmov2` for all simulations. See
+//' `makemov`.
+//'
+//' @param frac Matrix (nsim by nareas) of the fraction of the unfished stock in
+//' each area
+//' @param prb Matrix (nsim by nareas) of the probability of staying in each area.
+//' `NA` if not specified.
+//' @param maxage The maximum age
+//'
+//' @return Array of movement with dimensions `c(nsim, maxage, nareas, nareas)`
+//' that is the same for all ages
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector movFitCPP(NumericMatrix frac, NumericMatrix prb, int maxage) {
+  int nsim = frac.nrow();
+  int n = frac.ncol();
+  int npar = (n > 2) ? 2 * n - 1 : n;
+  MovFit fit(n);
+  std::vector<double> f(n), p(n), par(npar), best(npar);
+  NumericVector out(no_init((R_xlen_t) nsim * maxage * n * n));
+
+  for (int s = 0; s < nsim; s++) {
+    checkUserInterrupt();
+    for (int i = 0; i < n; i++) {
+      f[i] = frac(s, i);
+      p[i] = prb(s, i);
+      par[i] = ISNAN(p[i]) ? 0 : std::log(p[i]/(1 - p[i]));
+    }
+    if (n > 2) for (int j = 1; j < n; j++) par[n + j - 1] = std::log(f[j]/f[0]);
+    fit.frac = f.data();
+    fit.prb = p.data();
+
+    // restart until the fit no longer improves
+    double Fmin = R_PosInf, last;
+    int fail, fncount;
+    for (int it = 0; it < 5; it++) {
+      last = Fmin;
+      nmmin(npar, par.data(), best.data(), &Fmin, movfit_fn, &fail, 1e-16, 1e-12,
+            &fit, 1.0, 0.5, 2.0, 0, &fncount, 5000);
+      par = best;
+      if (Fmin >= last - 1e-14) break;
+    }
+
+    fit.movmat(best.data());
+    for (int a = 0; a < maxage; a++)
+      for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+          out[s + (R_xlen_t) nsim * (a + (R_xlen_t) maxage * (i + (R_xlen_t) n * j))] = fit.P[i + n * j];
+  }
+  out.attr("dim") = IntegerVector::create(nsim, maxage, n, n);
+  return out;
+}
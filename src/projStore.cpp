@@ -0,0 +1,144 @@
+#include <Rcpp.h>
+#include <vector>
+using namespace Rcpp;
+
+// At-age projection arrays (see R/ProjStore.R). Each array has dimensions
+// c(nsim, maxage, proyears, nareas) in the same layout as an R array and is
+// filled one projection year at a time. The values can be held in single
+// precision, which halves the memory of the largest objects in the projections.
+// The population dynamics are always calculated in double precision: values are
+// only rounded when they are stored, converted back to double when they are
+// read, and sums are accumulated in double.
+struct ProjArray {
+  size_t nsim, maxage, nyears, nareas;
+  bool single;
+  std::vector<float> f;
+  std::vector<double> d;
+
+  ProjArray(int nsim_, int maxage_, int nyears_, int nareas_, bool single_) :
+    nsim(nsim_), maxage(maxage_), nyears(nyears_), nareas(nareas_), single(single_) {
+    size_t n = nsim * maxage * nyears * nareas;
+    if (single) f.assign(n, NAN); else d.assign(n, NA_REAL);
+  }
+
+  inline size_t index(size_t s, size_t a, size_t y, size_t r) const {
+    return s + nsim * (a + maxage * (y + nyears * r));
+  }
+
+  inline double get(size_t i) const {
+    if (!single) return d[i];
+    double val = f[i];
+    return ISNAN(val) ? NA_REAL : val;
+  }
+
+  inline void set(size_t i, double val) {
+    if (single) f[i] = (float) val; else d[i] = val;
+  }
+};
+
+static ProjArray* projArrayPtr(SEXP x) {
+  XPtr<ProjArray> ptr(x);
+  if (ptr.get() == NULL) stop("projection array has been released");
+  return ptr.get();
+}
+
+//' Create an at-age projection array
+//'
+//' @param dims Integer vector with the dimensions `c(nsim, maxage, proyears, nareas)`
+//' @param single Logical. Store the values in single precision?
+//'
+//' @return An external pointer to the array, filled with `NA`
+//' @seealso \link{initProjStore}
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+SEXP projArray(IntegerVector dims, bool single = false) {
+  if (dims.size() != 4) stop("dims must be c(nsim, maxage, proyears, nareas)");
+  XPtr<ProjArray> ptr(new ProjArray(dims[0], dims[1], dims[2], dims[3], single), true);
+  return ptr;
+}
+
+//' Write one year of an at-age projection array
+//'
+//' @param x External pointer to the array (see `projArray`)
+//' @param y The projection year (1-based)
+//' @param val Numeric array of the values for year `y` with dimensions
+//' `c(nsim, maxage, nareas)`
+//'
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+void projArraySet(SEXP x, int y, NumericVector val) {
+  ProjArray* arr = projArrayPtr(x);
+  if (y < 1 || (size_t) y > arr->nyears) stop("year out of range");
+  if ((size_t) val.size() != arr->nsim * arr->maxage * arr->nareas)
+    stop("values must have dimensions c(nsim, maxage, nareas)");
+  size_t i = 0;
+  for (size_t r = 0; r < arr->nareas; r++) {
+    size_t k = arr->index(0, 0, y - 1, r);
+    for (size_t sa = 0; sa < arr->nsim * arr->maxage; sa++) arr->set(k + sa, val[i++]);
+  }
+}
+
+//' Read years of an at-age projection array
+//'
+//' @param x External pointer to the array (see `projArray`)
+//' @param yrs Integer vector of projection years (1-based)
+//'
+//' @return Numeric array with dimensions `c(nsim, maxage, length(yrs), nareas)`
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector projArrayGet(SEXP x, IntegerVector yrs) {
+  ProjArray* arr = projArrayPtr(x);
+  size_t ny = yrs.size();
+  size_t nsa = arr->nsim * arr->maxage;
+  NumericVector out(no_init(nsa * ny * arr->nareas));
+  size_t i = 0;
+  for (size_t r = 0; r < arr->nareas; r++) {
+    for (size_t k = 0; k < ny; k++) {
+      if (yrs[k] < 1 || (size_t) yrs[k] > arr->nyears) stop("year out of range");
+      size_t j = arr->index(0, 0, yrs[k] - 1, r);
+      for (size_t sa = 0; sa < nsa; sa++) out[i++] = arr->get(j + sa);
+    }
+  }
+  out.attr("dim") = IntegerVector::create(arr->nsim, arr->maxage, ny, arr->nareas);
+  return out;
+}
+
+//' Sums of an at-age projection array
+//'
+//' @param x External pointer to the array (see `projArray`)
+//' @param byAge Logical. Sum over areas only (`TRUE`), or over ages and areas (`FALSE`)?
+//' @param na_rm Logical. Should missing values be removed?
+//'
+//' @return A numeric array with dimensions `c(nsim, maxage, proyears)` if `byAge`
+//' is `TRUE`, otherwise a matrix with dimensions `c(nsim, proyears)`. The same as
+//' `apply(x, c(1, 2, 3), sum)` or `apply(x, c(1, 3), sum)` respectively.
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector projArraySum(SEXP x, bool byAge = false, bool na_rm = false) {
+  ProjArray* arr = projArrayPtr(x);
+  size_t nsim = arr->nsim, maxage = arr->maxage, nyears = arr->nyears;
+  size_t nage = byAge ? maxage : 1;
+  NumericVector out(nsim * nage * nyears);
+  for (size_t y = 0; y < nyears; y++) {
+    for (size_t s = 0; s < nsim; s++) {
+      for (size_t r = 0; r < arr->nareas; r++) {
+        for (size_t a = 0; a < maxage; a++) {
+          double val = arr->get(arr->index(s, a, y, r));
+          if (na_rm && ISNAN(val)) continue;
+          size_t o = byAge ? s + nsim * (a + maxage * y) : s + nsim * y;
+          out[o] += val;
+        }
+      }
+    }
+  }
+  if (byAge) {
+    out.attr("dim") = IntegerVector::create(nsim, maxage, nyears);
+  } else {
+    out.attr("dim") = IntegerVector::create(nsim, nyears);
+  }
+  return out;
+}
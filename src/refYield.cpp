@@ -0,0 +1,181 @@
+#include <Rcpp.h>
+#include "brent.h"
+#include "movArray.h"
+using namespace Rcpp;
+
+// Projection of one simulation at a fixed apical F for the reference yield (see
+// optMSY and getFref3). The population is projected for pyears from the last
+// historical year with popdynCPP control=2 dynamics. Only the numbers-at-age of
+// the current year are kept and the removals are only summed for the last 5
+// years. The inputs are read from the arrays of all simulations at the same
+// year offsets as the subsets used by getFref3, rather than copied.
+struct RefYSim {
+  int s, nsim, maxage, nareas, nyears, pyears, SRrel, plusgroup, nMPA;
+  const double *N, *Asize, *SSBpR, *MPA, *Perr, *M, *Mat, *Wt, *V, *R0a, *aR, *bR;
+  const MovArray* mov;
+  double h, Spat, maxF;
+
+  // element of an nsim x maxage x nyears + proyears array
+  inline double age_yr(const double* x, int a, int y) const {
+    return x[s + (size_t) nsim * (a + (size_t) maxage * y)];
+  }
+
+  // mean removals in weight over the last 5 years of the projection
+  double yield(double Fapic) const {
+    std::vector<double> Ncur(maxage * nareas), Nnext(maxage * nareas), Z(maxage * nareas);
+    std::vector<double> SB(nareas), VB(nareas), fishdist(nareas);
+    for (int A = 0; A < nareas; A++)
+      for (int a = 0; a < maxage; a++)
+        Ncur[a + maxage * A] = N[s + (size_t) nsim * (a + (size_t) maxage * ((size_t) nyears - 1 + (size_t) nyears * A))];
+
+    double Ctot = 0;
+    for (int y = 0; y < pyears; y++) {
+      // M, maturity and weight from the last historical year, selectivity from the first projection year
+      int yb = nyears - 1 + y;
+      int yv = nyears + y;
+      for (int A = 0; A < nareas; A++) {
+        SB[A] = 0;
+        VB[A] = 0;
+        for (int a = 0; a < maxage; a++) {
+          double NW = Ncur[a + maxage * A] * age_yr(Wt, a, yb);
+          SB[A] += NW * age_yr(Mat, a, yb);
+          VB[A] += NW * age_yr(V, a, yv);
+        }
+      }
+
+      // fishing mortality - distributed by vulnerable biomass and open areas
+      double tot = 0;
+      for (int A = 0; A < nareas; A++) {
+        fishdist[A] = std::pow(VB[A], Spat);
+        tot += fishdist[A];
+      }
+      for (int A = 0; A < nareas; A++) fishdist[A] /= tot;
+      if (y > 0) {
+        double fracE = 0;
+        for (int A = 0; A < nareas; A++) {
+          fishdist[A] *= MPA[y - 1 + (size_t) nMPA * A];
+          fracE += fishdist[A];
+        }
+        for (int A = 0; A < nareas; A++) fishdist[A] = fishdist[A] * (fracE + (1 - fracE))/fracE;
+      }
+      for (int A = 0; A < nareas; A++) {
+        for (int a = 0; a < maxage; a++) {
+          double FM = (Fapic * fishdist[A] * age_yr(V, a, yv))/Asize[s + nsim * A];
+          if (FM > maxF) FM = maxF;
+          double Za = age_yr(M, a, yb) + FM;
+          Z[a + maxage * A] = Za;
+          if (y >= pyears - 5)
+            Ctot += FM/Za * Ncur[a + maxage * A] * (1 - std::exp(-Za)) * age_yr(Wt, a, yb);
+        }
+      }
+      if (y == pyears - 1) break;
+
+      // recruitment and mortality (as popdynOneTScpp)
+      double Prec = Perr[s + (size_t) nsim * (yb + maxage)];
+      for (int A = 0; A < nareas; A++) {
+        double R0 = R0a[s + nsim * A];
+        if (SRrel == 1) {
+          Nnext[maxage * A] = Prec * (4 * R0 * h * SB[A])/(SSBpR[s + nsim * A] * R0 * (1 - h) + (5 * h - 1) * SB[A]);
+        } else {
+          Nnext[maxage * A] = Prec * aR[s + nsim * A] * SB[A] * std::exp(-bR[s + nsim * A] * SB[A]);
+        }
+        for (int a = 1; a < maxage; a++)
+          Nnext[a + maxage * A] = Ncur[a - 1 + maxage * A] * std::exp(-Z[a - 1 + maxage * A]);
+        if (plusgroup > 0)
+          Nnext[maxage - 1 + maxage * A] /= (1 - std::exp(-Z[maxage - 1 + maxage * A]));
+      }
+
+      // movement (getFref3 passes the movement of the first years)
+      for (int a = 0; a < maxage; a++) {
+        for (int B = 0; B < nareas; B++) {
+          double val = 0;
+          for (int A = 0; A < nareas; A++) {
+            val += Nnext[a + maxage * A] * (*mov)(s, a, A, B, y);
+          }
+          Ncur[a + maxage * B] = val;
+        }
+      }
+    }
+    return Ctot/std::min(5, pyears);
+  }
+
+  // objective of optMSY
+  double operator()(double logFa) {
+    return -yield(std::exp(logFa));
+  }
+};
+
+//' Reference yield for all simulations
+//'
+//' The highest mean yield over the last 5 projection years with a fixed apical
+//' fishing mortality, as calculated by `getFref3`. The apical F is searched with
+//' the same algorithm as `optimize` and the projection is run in compiled code
+//' for each simulation in turn.
+//'
+//' @param N Array of numbers-at-age with dimensions `c(nsim, maxage, nyears, nareas)`
+//' @param Asize Matrix of area size (nsim by nareas)
+//' @param M_ageArray Array of natural mortality (nsim, maxage, nyears + proyears)
+//' @param Mat_age Array of maturity-at-age (nsim, maxage, nyears + proyears)
+//' @param Wt_age Array of weight-at-age (nsim, maxage, nyears + proyears)
+//' @param V Array of vulnerability-at-age (nsim, maxage, nyears + proyears)
+//' @param Perr Matrix of recruitment deviations (nsim by nyears + proyears + maxage - 1)
+//' @param mov Array of movement (nsim, maxage, nareas, nareas, nyears + proyears). See `compactMov`.
+//' @param MPA Matrix (nyears + proyears by nareas) of spatial closures
+//' @param SRrel Integer vector (nsim long) of stock-recruit relationships (1: Beverton-Holt, 2: Ricker)
+//' @param Spat_targ Vector (nsim long) of spatial targeting parameters
+//' @param hs Vector (nsim long) of steepness
+//' @param R0a Matrix (nsim by nareas) of unfished recruitment
+//' @param SSBpR Matrix (nsim by nareas) of SSB per recruit
+//' @param aR Matrix (nsim by nareas) of Ricker a parameters
+//' @param bR Matrix (nsim by nareas) of Ricker b parameters
+//' @param proyears Number of projection years
+//' @param maxF Maximum fishing mortality for any age class
+//' @param plusgroup Integer. Include a plus-group (1) or not (0)?
+//'
+//' @return Vector (nsim long) of reference yield
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector getRefYCPP(NumericVector N, NumericMatrix Asize, NumericVector M_ageArray,
+                         NumericVector Mat_age, NumericVector Wt_age, NumericVector V,
+                         NumericMatrix Perr, NumericVector mov, NumericMatrix MPA,
+                         IntegerVector SRrel, NumericVector Spat_targ, NumericVector hs,
+                         NumericMatrix R0a, NumericMatrix SSBpR, NumericMatrix aR, NumericMatrix bR,
+                         int proyears, double maxF, int plusgroup) {
+  IntegerVector Ndim = N.attr("dim");
+  RefYSim sim;
+  sim.nsim = Ndim[0];
+  sim.maxage = Ndim[1];
+  sim.nyears = Ndim[2];
+  sim.nareas = Ndim[3];
+  sim.pyears = proyears;
+  sim.nMPA = MPA.nrow();
+  sim.plusgroup = plusgroup;
+  sim.N = N.begin();
+  sim.Asize = Asize.begin();
+  sim.SSBpR = SSBpR.begin();
+  sim.MPA = MPA.begin();
+  sim.Perr = Perr.begin();
+  sim.M = M_ageArray.begin();
+  sim.Mat = Mat_age.begin();
+  sim.Wt = Wt_age.begin();
+  sim.V = V.begin();
+  sim.R0a = R0a.begin();
+  sim.aR = aR.begin();
+  sim.bR = bR.begin();
+  MovArray movarr(mov);
+  sim.mov = &movarr;
+  sim.maxF = maxF;
+
+  NumericVector RefY(sim.nsim);
+  for (int s = 0; s < sim.nsim; s++) {
+    checkUserInterrupt();
+    sim.s = s;
+    sim.SRrel = SRrel[s];
+    sim.h = hs[s];
+    sim.Spat = Spat_targ[s];
+    double logFa = brent_fmin(std::log(0.001), std::log(10.0), sim);
+    RefY[s] = sim.yield(std::exp(logFa));
+  }
+  return RefY;
+}
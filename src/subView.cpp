@@ -0,0 +1,158 @@
+#include <Rcpp.h>
+#include <Rversion.h>
+using namespace Rcpp;
+
+// Subsets of numeric arrays that refer to the parent array rather than copying
+// it (see SubView in R/MSE_functions.R). On R >= 3.5 the subset is an ALTREP
+// object that reads elements from the parent as they are used and is only
+// copied into its own memory when R needs a pointer to the whole array.
+// Elsewhere the subset is copied straight away.
+
+// Position in the parent array of element i of the subset.
+// idx: 0-based index vectors for each dimension of the parent
+static R_xlen_t view_parent_pos(SEXP idx, SEXP pdim, R_xlen_t i) {
+  R_xlen_t pos = 0;
+  R_xlen_t mult = 1;
+  int *pd = INTEGER(pdim);
+  for (int k = 0; k < Rf_length(idx); k++) {
+    SEXP ik = VECTOR_ELT(idx, k);
+    R_xlen_t nk = XLENGTH(ik);
+    pos += (R_xlen_t) INTEGER(ik)[i % nk] * mult;
+    i /= nk;
+    mult *= pd[k];
+  }
+  return pos;
+}
+
+static void view_fill(SEXP parent, SEXP idx, SEXP pdim, double *out, R_xlen_t start, R_xlen_t n) {
+  const double *px = REAL(parent);
+  for (R_xlen_t j = 0; j < n; j++) out[j] = px[view_parent_pos(idx, pdim, start + j)];
+}
+
+#if defined(R_VERSION) && R_VERSION >= R_Version(3, 5, 0)
+#define DLM_VIEW 1
+
+#if R_VERSION < R_Version(3, 6, 0)
+#define class klass
+extern "C" {
+#include <R_ext/Altrep.h>
+}
+#undef class
+#else
+#include <R_ext/Altrep.h>
+#endif
+
+static R_altrep_class_t view_real_class;
+
+// data1: list(parent, index vectors, parent dimensions)
+// data2: the copy of the subset, or R_NilValue until it is required
+static R_xlen_t view_real_length(SEXP x) {
+  SEXP idx = VECTOR_ELT(R_altrep_data1(x), 1);
+  R_xlen_t n = 1;
+  for (int k = 0; k < Rf_length(idx); k++) n *= XLENGTH(VECTOR_ELT(idx, k));
+  return n;
+}
+
+static Rboolean view_real_inspect(SEXP x, int pre, int deep, int pvec,
+                                  void (*inspect_subtree)(SEXP, int, int, int)) {
+  Rprintf("view_real (len=%.0f, %s)\n", (double) view_real_length(x),
+          R_altrep_data2(x) == R_NilValue ? "view" : "copied");
+  return TRUE;
+}
+
+static void *view_real_dataptr(SEXP x, Rboolean writeable) {
+  SEXP copy = R_altrep_data2(x);
+  if (copy == R_NilValue) {
+    SEXP info = R_altrep_data1(x);
+    R_xlen_t n = view_real_length(x);
+    copy = PROTECT(Rf_allocVector(REALSXP, n));
+    view_fill(VECTOR_ELT(info, 0), VECTOR_ELT(info, 1), VECTOR_ELT(info, 2), REAL(copy), 0, n);
+    R_set_altrep_data2(x, copy);
+    // the parent is no longer needed
+    SET_VECTOR_ELT(info, 0, R_NilValue);
+    UNPROTECT(1);
+  }
+  return (void *) REAL(copy);
+}
+
+static const void *view_real_dataptr_or_null(SEXP x) {
+  SEXP copy = R_altrep_data2(x);
+  if (copy == R_NilValue) return NULL;
+  return (const void *) REAL(copy);
+}
+
+static double view_real_elt(SEXP x, R_xlen_t i) {
+  SEXP copy = R_altrep_data2(x);
+  if (copy != R_NilValue) return REAL(copy)[i];
+  SEXP info = R_altrep_data1(x);
+  return REAL_ELT(VECTOR_ELT(info, 0), view_parent_pos(VECTOR_ELT(info, 1), VECTOR_ELT(info, 2), i));
+}
+
+static R_xlen_t view_real_get_region(SEXP x, R_xlen_t i, R_xlen_t n, double *buf) {
+  R_xlen_t len = view_real_length(x);
+  R_xlen_t ncopy = (len - i > n) ? n : len - i;
+  SEXP copy = R_altrep_data2(x);
+  if (copy != R_NilValue) {
+    for (R_xlen_t k = 0; k < ncopy; k++) buf[k] = REAL(copy)[i + k];
+  } else {
+    SEXP info = R_altrep_data1(x);
+    view_fill(VECTOR_ELT(info, 0), VECTOR_ELT(info, 1), VECTOR_ELT(info, 2), buf, i, ncopy);
+  }
+  return ncopy;
+}
+#endif
+
+// Register the ALTREP class when the package is loaded
+// [[Rcpp::init]]
+void init_view_real(DllInfo *dll) {
+#ifdef DLM_VIEW
+  view_real_class = R_make_altreal_class("view_real", "DLMtool", dll);
+  R_set_altrep_Length_method(view_real_class, view_real_length);
+  R_set_altrep_Inspect_method(view_real_class, view_real_inspect);
+  R_set_altvec_Dataptr_method(view_real_class, view_real_dataptr);
+  R_set_altvec_Dataptr_or_null_method(view_real_class, view_real_dataptr_or_null);
+  R_set_altreal_Elt_method(view_real_class, view_real_elt);
+  R_set_altreal_Get_region_method(view_real_class, view_real_get_region);
+#endif
+}
+
+//' Subset of a numeric array that refers to the parent array
+//'
+//' Equivalent to `x[index[[1]], index[[2]], ..., drop=FALSE]` without the
+//' dimensions. Where ALTREP is available the elements are read from `x` as they
+//' are used and the subset is only copied when required.
+//'
+//' @param x A numeric array
+//' @param index List of integer vectors (1-based) with the indices of each
+//' dimension of `x`
+//'
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+SEXP subView(NumericVector x, List index) {
+  IntegerVector pdim = x.attr("dim");
+  if (index.size() != pdim.size()) stop("`index` must have an element for each dimension of `x`");
+  List idx(index.size());
+  R_xlen_t n = 1;
+  for (int k = 0; k < index.size(); k++) {
+    IntegerVector ik = clone(as<IntegerVector>(index[k]));
+    for (R_xlen_t j = 0; j < ik.size(); j++) {
+      if (ik[j] == NA_INTEGER || ik[j] < 1 || ik[j] > pdim[k]) stop("subscript out of bounds");
+      ik[j] -= 1;
+    }
+    idx[k] = ik;
+    n *= ik.size();
+  }
+
+#ifdef DLM_VIEW
+  if (n > 0) {
+    // the view refers to x, so x must be copied rather than modified in place
+    MARK_NOT_MUTABLE(x);
+    List info = List::create(x, idx, pdim);
+    return R_new_altrep(view_real_class, info, R_NilValue);
+  }
+#endif
+  NumericVector out(n);
+  if (n > 0) view_fill(x, idx, pdim, out.begin(), 0, n);
+  return out;
+}
@@ -0,0 +1,119 @@
+#include <Rcpp.h>
+#include "movArray.h"
+using namespace Rcpp;
+
+// Unfished spatial equilibrium when the movement matrix is provided in cpars
+// (previously found by projecting each simulation with popdynCPP control=3).
+// In the unfished equilibrium of the control=3 dynamics the recruitment to each
+// area is R0 times the fraction of the spawning biomass in that area, for both
+// the Beverton-Holt and Ricker relationships. The numbers-at-age are linear in
+// the recruitment by area, so the recruitment is the dominant eigenvector of
+// the nareas by nareas matrix of spawning biomass in each area per recruit to
+// each area. This is found by power iteration.
+
+//' Unfished spatial equilibrium numbers-at-age
+//'
+//' @param N Array of initial numbers-at-age with dimensions `c(nsim, maxage, nyears, nareas)`.
+//' The distribution of spawning biomass in the first year is the starting value
+//' for the recruitment by area.
+//' @param M_ageArray Array of natural mortality with dimensions `c(nsim, maxage, nyears + proyears)`
+//' @param Wt_age Array of weight-at-age, as `M_ageArray`
+//' @param Mat_age Array of maturity-at-age, as `M_ageArray`
+//' @param mov Array of movement with dimensions `c(nsim, maxage, nareas, nareas)`
+//' or `c(nsim, maxage, nareas, nareas, nyears + proyears)`. See `compactMov`.
+//' @param R0 Vector (nsim long) of unfished recruitment
+//' @param tol Convergence tolerance for the fraction of recruitment to each area
+//' @param maxit Maximum number of iterations
+//'
+//' @details The values of the first year are used for natural mortality,
+//' weight, maturity and movement.
+//'
+//' @return Array of numbers-at-age with dimensions `c(nsim, maxage, nareas)`
+//' @author A. Hordyk
+//' @keywords internal
+// [[Rcpp::export]]
+NumericVector unfishedEq(NumericVector N, NumericVector M_ageArray, NumericVector Wt_age,
+                         NumericVector Mat_age, NumericVector mov, NumericVector R0,
+                         double tol = 1e-12, int maxit = 10000) {
+  IntegerVector Ndim = N.attr("dim");
+  int nsim = Ndim[0];
+  int maxage = Ndim[1];
+  int nyears = Ndim[2];
+  int nareas = Ndim[3];
+
+  MovArray movarr(mov);
+  NumericVector out(no_init((R_xlen_t) nsim * maxage * nareas));
+  // numbers-at-age per recruit to each area: L[a, B, A] for recruits to area A
+  std::vector<double> L(maxage * nareas * nareas);
+  std::vector<double> S(nareas * nareas), r(nareas), rnew(nareas);
+
+  for (int s = 0; s < nsim; s++) {
+    checkUserInterrupt();
+    // survival and movement of one recruit to each area
+    for (int A = 0; A < nareas; A++) {
+      for (int B = 0; B < nareas; B++) {
+        L[maxage * (B + nareas * A)] = movarr(s, 0, A, B, 0);
+      }
+      for (int a = 1; a < maxage; a++) {
+        double surv = std::exp(-M_ageArray[s + (size_t) nsim * (a - 1)]);
+        for (int B = 0; B < nareas; B++) {
+          double val = 0;
+          for (int C = 0; C < nareas; C++) {
+            val += L[a - 1 + maxage * (C + nareas * A)] * surv * movarr(s, a, C, B, 0);
+          }
+          L[a + maxage * (B + nareas * A)] = val;
+        }
+      }
+    }
+
+    // spawning biomass in area B per recruit to area A
+    for (int A = 0; A < nareas; A++) {
+      for (int B = 0; B < nareas; B++) {
+        double sb = 0;
+        for (int a = 0; a < maxage; a++) {
+          size_t i = s + (size_t) nsim * a;
+          sb += L[a + maxage * (B + nareas * A)] * Wt_age[i] * Mat_age[i];
+        }
+        S[B + nareas * A] = sb;
+      }
+    }
+
+    // starting values from the initial distribution of spawning biomass
+    double tot = 0;
+    for (int A = 0; A < nareas; A++) {
+      r[A] = 0;
+      for (int a = 0; a < maxage; a++) {
+        size_t i = s + (size_t) nsim * a;
+        r[A] += N[s + (size_t) nsim * (a + (size_t) maxage * (size_t) nyears * A)] * Wt_age[i] * Mat_age[i];
+      }
+      tot += r[A];
+    }
+    for (int A = 0; A < nareas; A++) r[A] = (tot > 0) ? r[A]/tot : 1.0/nareas;
+
+    for (int it = 0; it < maxit; it++) {
+      tot = 0;
+      for (int B = 0; B < nareas; B++) {
+        rnew[B] = 0;
+        for (int A = 0; A < nareas; A++) rnew[B] += S[B + nareas * A] * r[A];
+        tot += rnew[B];
+      }
+      double diff = 0;
+      for (int A = 0; A < nareas; A++) {
+        rnew[A] /= tot;
+        diff = std::max(diff, std::fabs(rnew[A] - r[A]));
+        r[A] = rnew[A];
+      }
+      if (diff < tol) break;
+    }
+
+    for (int B = 0; B < nareas; B++) {
+      for (int a = 0; a < maxage; a++) {
+        double val = 0;
+        for (int A = 0; A < nareas; A++) val += L[a + maxage * (B + nareas * A)] * r[A];
+        out[s + (size_t) nsim * (a + (size_t) maxage * B)] = R0[s] * val;
+      }
+    }
+  }
+  out.attr("dim") = IntegerVector::create(nsim, maxage, nareas);
+  return out;
+}